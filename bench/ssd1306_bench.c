@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "ssd1306.h"
+#include "images.h"
+
+// Benchmark das primitivas de desenho e dos caminhos de envio do SSD1306, com resultado em CSV no stdio.
+// Na placa o tempo vem do timer de microssegundos (e os ciclos do clk_sys) e os bytes i2c são os contadores
+// do gerenciador dos dois barramentos, que incluem os envios por DMA. No host os bytes são contados pelos
+// displays simulados
+
+#define I2C_SDA 14
+#define I2C_SCL 15
+#define I2C_SECOND_SDA 0 // Segundo painel (opcional), no outro bloco i2c
+#define I2C_SECOND_SCL 1
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+
+#define BENCH_REPEAT_MS 5000 // Repete a tabela para quem abrir o terminal depois
+
+#define i2c_transactions (i2c_bus_get(1)->stats.transactions + (i2c_bus_get(0) ? i2c_bus_get(0)->stats.transactions : 0))
+#define i2c_bytes (i2c_bus_get(1)->stats.bytes + (i2c_bus_get(0) ? i2c_bus_get(0)->stats.bytes : 0))
+
+static uint64_t bench_time_ns()
+{
+    return time_us_64() * 1000;
+}
+
+#else
+#include <time.h>
+#include "sim.h"
+
+#define i2c_transactions (sim_i2c_stats.transactions)
+#define i2c_bytes (sim_i2c_stats.bytes)
+
+// O benchmark não usa os pinos simulados (sim_gpio.c depende do teclado): a inicialização e a recuperação
+// do barramento só passam por estes, com as linhas sempre soltas
+void gpio_set_function(uint gpio, enum gpio_function fn) {}
+void gpio_set_dir(uint gpio, bool out) {}
+void gpio_put(uint gpio, bool value) {}
+void gpio_pull_up(uint gpio) {}
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) {}
+
+bool gpio_get(uint gpio)
+{
+    return true;
+}
+
+static uint64_t bench_time_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+#endif
+
+#define BENCH_PRIMITIVE_RUNS 2000
+#define BENCH_FLUSH_RUNS 50
+
+#define W (oled.width)
+#define H (oled.height)
+
+static ssd1306_t oled;
+static ssd1306_t second; // Sem resposta no i2c0, os casos com dois painéis são pulados
+static bool second_ok = false;
+static volatile uint32_t dma_done = 0; // Um bit por painel
+
+static struct render_area frame;
+
+// Medição corrente: tempo e tráfego i2c acumulados só dentro de bench_start/bench_stop
+typedef struct
+{
+    const char *name;
+    int runs;
+    uint64_t elapsed_ns;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint64_t start_ns;
+    uint32_t start_transactions;
+    uint32_t start_bytes;
+    bool counted;
+} bench_t;
+
+static void bench_start(bench_t *bench)
+{
+    bench->start_transactions = i2c_transactions;
+    bench->start_bytes = i2c_bytes;
+    bench->start_ns = bench_time_ns();
+}
+
+static void bench_stop(bench_t *bench)
+{
+    bench->elapsed_ns += bench_time_ns() - bench->start_ns;
+    bench->transactions += i2c_transactions - bench->start_transactions;
+    bench->bytes += i2c_bytes - bench->start_bytes;
+}
+
+static void bench_report(const bench_t *bench)
+{
+    double runs = bench->runs;
+
+    printf("%s,%d,%.1f,", bench->name, bench->runs, bench->elapsed_ns / runs);
+#if PICO_ON_DEVICE
+    printf("%.0f,", bench->elapsed_ns / runs * clock_get_hz(clk_sys) / 1e9);
+#else
+    printf(",");
+#endif
+    if (bench->counted)
+        printf("%.2f,%.1f\n", bench->transactions / runs, bench->bytes / runs);
+    else
+        printf(",\n");
+}
+
+// Gerador congruente simples: as mesmas coordenadas em toda execução
+static uint32_t bench_seed;
+
+static int bench_random(int limit)
+{
+    bench_seed = bench_seed * 1664525u + 1013904223u;
+    return (bench_seed >> 8) % limit;
+}
+
+static void on_dma_done(ssd1306_t *ssd)
+{
+    dma_done |= ssd == &oled ? 1 : 2;
+}
+
+// Deixa o painel e o controle de páginas alteradas num estado conhecido antes de cada caso
+static void bench_reset_panel()
+{
+    memset(oled.buffer, 0, oled.bufsize);
+    render_on_display(&oled, &frame);
+}
+
+static void bench_primitives()
+{
+    bench_t bench;
+
+    bench = (bench_t){.name = "set_pixel", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_seed = 1;
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_set_pixel(&oled, bench_random(W), bench_random(H), i & 1);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "draw_line", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_seed = 2;
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_draw_line(&oled, bench_random(W), bench_random(H),
+                          bench_random(W), bench_random(H), true);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "draw_char", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_draw_char(&oled, (i * 8) % W, (i * 8) % H, 'A' + i % 26);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "draw_string_16", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_draw_string(&oled, 0, (i * 8) % H, "ACCESS GRANTED  ");
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "draw_string_unaligned", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_draw_string(&oled, 0, (i * 3) % (H - 7), "TRIES LEFT: 2   ");
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "draw_text_16x16", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_draw_text(&oled, &ssd1306_font_16x16, 0, (i * 16) % H, "12345678");
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "blit_image_rle_32x32", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_blit_image(&oled, &image_lock_open_32, (i * 8) % W, 0, NULL);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "clear", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_clear(&oled);
+    bench_stop(&bench);
+    bench_report(&bench);
+}
+
+// Primitivas por página (máscaras de bytes e palavras de 32 bits) contra o mesmo desenho pixel a pixel
+static void bench_raster()
+{
+    const uint8_t *glyph = ssd1306_font_16x16.glyphs + ssd1306_font_16x16.index['8'] * ssd1306_font_16x16.width * ssd1306_font_16x16.pages;
+    bench_t bench;
+
+    bench = (bench_t){.name = "fill_rect_100x20_per_pixel", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        for (int y = 5; y < 25; y++)
+            for (int x = 10; x < 110; x++)
+                ssd1306_set_pixel(&oled, x, y, i & 1);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "fill_rect_100x20", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_fill_rect(&oled, 10, 5, 100, 20, (i & 1) ? SSD1306_COLOR_WHITE : SSD1306_COLOR_BLACK);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "invert_rect_100x20", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_fill_rect(&oled, 10, 5, 100, 20, SSD1306_COLOR_INVERT);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "hline_120_per_pixel", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        for (int x = 4; x < 124; x++)
+            ssd1306_set_pixel(&oled, x, i % H, true);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "hline_120", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_hline(&oled, 4, i % H, 120, SSD1306_COLOR_WHITE);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    // Barra do campo de senha (ui_bar): contorno e preenchimento numa linha fora das páginas
+    bench = (bench_t){.name = "progress_bar_128x8", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+    {
+        ssd1306_draw_rect(&oled, 0, H - 10, W, 8, SSD1306_COLOR_WHITE);
+        ssd1306_fill_rect(&oled, 2, H - 8, i % (W - 4), 4, SSD1306_COLOR_WHITE);
+    }
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench = (bench_t){.name = "blit_masked_16x16_unaligned", .runs = BENCH_PRIMITIVE_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_blit_masked(&oled, glyph, glyph, 16, 16, (i * 8) % W, (i * 3) % (H - 15));
+    bench_stop(&bench);
+    bench_report(&bench);
+}
+
+// Alterna entre dois quadros cheios, para que todo envio tenha a tela inteira diferente do painel
+static void bench_fill_frame(ssd1306_t *ssd, int i)
+{
+    memset(ssd->buffer, (i & 1) ? 0x55 : 0xAA, ssd->bufsize);
+    ssd1306_mark_dirty(ssd, 0, 0, ssd->width, ssd->height);
+}
+
+// Troca uma linha de texto, o caso típico de uma transição de estado do cofre
+static void bench_text_line(int i)
+{
+    ssd1306_draw_string(&oled, 0, 32, (i & 1) ? "TRY PASSWORD    " : "ACCESS DENIED   ");
+}
+
+// Dispara o envio de cada painel e espera todos terminarem (ou o prazo do mais lento); painéis em blocos
+// i2c diferentes enviam ao mesmo tempo
+static void bench_flush_async_panels(ssd1306_t **panels, int count)
+{
+    uint32_t started = 0;
+    uint32_t timeout_us = 0;
+
+    dma_done = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (ssd1306_flush_async(panels[i]))
+        {
+            started |= panels[i] == &oled ? 1 : 2;
+            timeout_us = MAX(timeout_us, ssd1306_flush_timeout_us(panels[i]));
+        }
+    }
+    if (!started)
+        return;
+
+    uint64_t due_ns = bench_time_ns() + timeout_us * 1000ull;
+    while ((dma_done & started) != started && bench_time_ns() < due_ns)
+        tight_loop_contents();
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t bit = panels[i] == &oled ? 1 : 2;
+        if (started & bit)
+            ssd1306_flush_end(panels[i], dma_done & bit);
+    }
+}
+
+static void bench_flush_async(ssd1306_t *ssd)
+{
+    bench_flush_async_panels(&ssd, 1);
+}
+
+static void bench_flush()
+{
+    bench_t bench;
+
+    bench = (bench_t){.name = "render_on_display_full", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        bench_fill_frame(&oled, i);
+        bench_start(&bench);
+        render_on_display(&oled, &frame);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+
+    bench_reset_panel();
+    bench = (bench_t){.name = "flush_full", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        bench_fill_frame(&oled, i);
+        bench_start(&bench);
+        ssd1306_flush(&oled);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+
+    bench_reset_panel();
+    bench = (bench_t){.name = "flush_text_line", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        bench_text_line(i);
+        bench_start(&bench);
+        ssd1306_flush(&oled);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+
+    bench_reset_panel();
+    bench = (bench_t){.name = "flush_unchanged", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        ssd1306_mark_dirty(&oled, 0, 0, W, H);
+        bench_start(&bench);
+        ssd1306_flush(&oled);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+
+    bench_reset_panel();
+    bench = (bench_t){.name = "flush_async_full", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        bench_fill_frame(&oled, i);
+        bench_start(&bench);
+        bench_flush_async(&oled);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+
+    bench_reset_panel();
+    bench = (bench_t){.name = "flush_async_text_line", .runs = BENCH_FLUSH_RUNS, .counted = !PICO_ON_DEVICE};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        bench_text_line(i);
+        bench_start(&bench);
+        bench_flush_async(&oled);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+}
+
+// Dois painéis, um em cada bloco i2c, com os envios por DMA sobrepostos
+static void bench_two_panels()
+{
+    ssd1306_t *panels[] = {&oled, &second};
+    bench_t bench;
+
+    if (!second_ok)
+        return;
+
+    bench_reset_panel();
+    bench = (bench_t){.name = "flush_async_two_panels", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        bench_fill_frame(&oled, i);
+        bench_fill_frame(&second, i);
+        bench_start(&bench);
+        bench_flush_async_panels(panels, count_of(panels));
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+}
+
+// Imagem inteira fornecida coluna por coluna (como no endereçamento vertical) e transposta para o framebuffer
+static void bench_bitmap()
+{
+    static uint8_t bitmap[ssd1306_max_buffer_length];
+    bench_t bench;
+
+    bench = (bench_t){.name = "draw_bitmap_full", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    for (int i = 0; i < bench.runs; i++)
+    {
+        memset(bitmap, (i & 1) ? 0x55 : 0xAA, oled.bufsize);
+        bench_start(&bench);
+        ssd1306_draw_bitmap(&oled, bitmap);
+        bench_stop(&bench);
+    }
+    bench_report(&bench);
+
+    // A posição alterna, para que cada desenho tenha o que enviar
+    bench_reset_panel();
+    bench = (bench_t){.name = "draw_image_rle_32x32", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_draw_image(&oled, &image_lock_open_32, (i & 1) ? 56 : 48, 2, NULL);
+    bench_stop(&bench);
+    bench_report(&bench);
+}
+
+static void bench_run()
+{
+    printf("benchmark,runs,ns_per_op,cycles_per_op,i2c_transactions_per_op,i2c_bytes_per_op\n");
+
+    bench_t bench = {.name = "init_commands", .runs = BENCH_FLUSH_RUNS, .counted = true};
+    bench_start(&bench);
+    for (int i = 0; i < bench.runs; i++)
+        ssd1306_config(&oled);
+    bench_stop(&bench);
+    bench_report(&bench);
+
+    bench_reset_panel();
+    bench_primitives();
+    bench_raster();
+    bench_flush();
+    bench_two_panels();
+    bench_bitmap();
+}
+
+int main()
+{
+#if PICO_ON_DEVICE
+    stdio_init_all();
+#endif
+
+    ssd1306_init(&oled, 128, 64, false, ssd1306_i2c_address, i2c_bus_init(i2c1, I2C_SDA, I2C_SCL, ssd1306_i2c_clock));
+    ssd1306_dma_init(&oled, on_dma_done);
+    frame = (struct render_area){.start_column = 0, .end_column = W - 1, .start_page = 0, .end_page = oled.pages - 1};
+    calculate_render_area_buffer_length(&frame);
+
+    second_ok = ssd1306_init(&second, 128, 64, false, ssd1306_i2c_address,
+                             i2c_bus_init(i2c0, I2C_SECOND_SDA, I2C_SECOND_SCL, ssd1306_i2c_clock));
+    if (second_ok)
+        ssd1306_dma_init(&second, on_dma_done);
+
+#if PICO_ON_DEVICE
+    while (true)
+    {
+        bench_run();
+        sleep_ms(BENCH_REPEAT_MS);
+    }
+#else
+    bench_run();
+    return 0;
+#endif
+}
@@ -0,0 +1,18 @@
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index
+{
+    clk_sys = 5,
+};
+
+// Frequência padrão do clk_sys no RP2040
+static inline uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    (void)clk_index;
+    return 125000000;
+}
+
+#endif
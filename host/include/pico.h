@@ -0,0 +1,49 @@
+#ifndef SIM_PICO_H
+#define SIM_PICO_H
+
+// Substituto mínimo do pico.h do SDK para a simulação no host: tipos, macros e o mapa de endereços usados pelo firmware
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+// Mesmas macros do SDK para distinguir a placa de uma compilação no host
+#define PICO_ON_DEVICE 0
+#define PICO_NO_HARDWARE 1
+
+typedef unsigned int uint;
+
+#define _u(x) x##u
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+void panic(const char *fmt, ...);
+
+// Dois núcleos como no RP2040, mas a simulação executa tudo como o núcleo 0
+#define NUM_CORES 2
+
+static inline uint get_core_num(void)
+{
+    return 0;
+}
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+// A flash simulada é um vetor em RAM (espelhado num arquivo); XIP_BASE aponta para ele
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+extern uint8_t sim_flash_memory[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_memory)
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef SIM_PICO_BINARY_INFO_H
+#define SIM_PICO_BINARY_INFO_H
+
+#define bi_decl(...)
+#define bi_2pins_with_func(...)
+
+#endif
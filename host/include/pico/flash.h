@@ -0,0 +1,9 @@
+#ifndef SIM_PICO_FLASH_H
+#define SIM_PICO_FLASH_H
+
+#include "pico.h"
+
+// No host não há outro núcleo nem XIP a proteger: a função é executada diretamente
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+
+#endif
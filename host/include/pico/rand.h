@@ -0,0 +1,15 @@
+#ifndef SIM_PICO_RAND_H
+#define SIM_PICO_RAND_H
+
+#include "pico.h"
+
+typedef struct
+{
+    uint64_t r[2];
+} rng_128_t;
+
+void get_rand_128(rng_128_t *rand128);
+uint32_t get_rand_32(void);
+uint64_t get_rand_64(void);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+#include "pico.h"
+#include "hardware/gpio.h"
+
+// O tempo simulado avança com o tick do FreeRTOS (um tick por milissegundo simulado); as esperas ativas não
+// consomem tempo, pois no host o hardware responde na hora
+void stdio_init_all(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+
+// A entrada do stdio é do roteiro: nada chega por getchar_timeout_us e o aviso de caracteres nunca dispara
+int getchar_timeout_us(uint32_t timeout_us);
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+
+static inline void tight_loop_contents(void) {}
+
+static inline void busy_wait_us_32(uint32_t delay_us)
+{
+    (void)delay_us;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+#include "pico.h"
+
+// Interface da simulação no host: o roteiro aciona teclas e observa o display, os LEDs e a flash simulados
+
+// Teclas do teclado matricial ('0'..'9', '*', '#') e botões ('A', 'B'); retorna false para tecla desconhecida
+bool sim_key_set(char key, bool pressed);
+bool sim_gpio_level(uint gpio);
+
+// Painel do i2c1 (cada bloco i2c tem o seu)
+bool sim_display_pixel(int x, int y);
+bool sim_display_contains(const char *text);
+void sim_display_dump(FILE *out);
+bool sim_display_on(void);
+uint8_t sim_display_contrast(void);
+bool sim_display_scrolling(void);
+
+// Falhas do barramento do display: as próximas naks transações recebem NACK no meio (o painel fica só com a
+// primeira metade); hang prende SDA até a recuperação do barramento. sim_i2c_khz é o clock atual do i2c1
+void sim_i2c_fault(int naks, bool hang);
+uint sim_i2c_khz(void);
+
+// Transações e bytes recebidos pelo display desde o início, pela escrita bloqueante ou pelo DMA
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t bytes;
+} sim_i2c_stats_t;
+
+extern sim_i2c_stats_t sim_i2c_stats;
+
+// Carrega a flash do arquivo (se existir) e passa a gravar nele cada apagamento/programação
+bool sim_flash_open(const char *path);
+
+// Uso interno dos modelos de hardware
+struct i2c_inst;
+void sim_gpio_update(void);
+bool sim_gpio_is_pwm(uint gpio);
+void sim_irq_raise(uint num);
+int sim_i2c_transaction(struct i2c_inst *i2c, uint8_t address, const uint8_t *data, size_t length);
+
+#endif
@@ -0,0 +1,191 @@
+#include <string.h>
+#include "sim.h"
+#include "hardware/dma.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+
+// Modelo do DMA: a transferência inteira acontece no disparo. Escritas no IC_DATA_CMD de um i2c viram bytes
+// do barramento, e o bit STOP encerra a transação; as demais são cópias de memória comuns. Um NACK registra
+// o abort no i2c, que descarta o resto da sequência; com o barramento preso o FIFO não esvazia e o canal
+// nunca termina (até dma_channel_abort)
+
+typedef struct
+{
+    bool claimed;
+    dma_channel_config config;
+    volatile void *write_addr;
+    const volatile void *read_addr;
+    uint transfer_count;
+    bool irq0_enabled;
+    bool irq0_status;
+} sim_dma_channel_t;
+
+static sim_dma_channel_t channels[NUM_DMA_CHANNELS];
+
+// Bytes da transação i2c montada pelo DMA, até a palavra com STOP
+static uint8_t i2c_transaction[2048];
+static size_t i2c_length = 0;
+
+static i2c_inst_t *i2c_for_data_cmd(volatile void *addr)
+{
+    if (addr == &i2c_get_hw(i2c0)->data_cmd)
+        return i2c0;
+    if (addr == &i2c_get_hw(i2c1)->data_cmd)
+        return i2c1;
+    return NULL;
+}
+
+static uint32_t read_word(const volatile uint8_t *addr, enum dma_channel_transfer_size size)
+{
+    switch (size)
+    {
+    case DMA_SIZE_8:
+        return *addr;
+    case DMA_SIZE_16:
+        return *(const volatile uint16_t *)addr;
+    default:
+        return *(const volatile uint32_t *)addr;
+    }
+}
+
+static void write_word(volatile uint8_t *addr, enum dma_channel_transfer_size size, uint32_t word)
+{
+    switch (size)
+    {
+    case DMA_SIZE_8:
+        *addr = word;
+        break;
+    case DMA_SIZE_16:
+        *(volatile uint16_t *)addr = word;
+        break;
+    default:
+        *(volatile uint32_t *)addr = word;
+        break;
+    }
+}
+
+static void dma_run(uint channel)
+{
+    sim_dma_channel_t *ch = &channels[channel];
+    int step = 1 << ch->config.size;
+    const volatile uint8_t *src = ch->read_addr;
+    volatile uint8_t *dst = ch->write_addr;
+    i2c_inst_t *i2c = i2c_for_data_cmd(ch->write_addr);
+
+    i2c_length = 0;
+    for (uint n = 0; n < ch->transfer_count; n++)
+    {
+        uint32_t word = read_word(src, ch->config.size);
+
+        if (i2c != NULL)
+        {
+            if (i2c_length < sizeof(i2c_transaction))
+                i2c_transaction[i2c_length++] = word & 0xFF;
+
+            if ((word & I2C_IC_DATA_CMD_STOP_BITS) && !(i2c_get_hw(i2c)->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS))
+            {
+                int result = sim_i2c_transaction(i2c, i2c_get_hw(i2c)->tar, i2c_transaction, i2c_length);
+                if (result == PICO_ERROR_TIMEOUT)
+                    return;
+                if (result != PICO_OK)
+                    i2c_get_hw(i2c)->raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+            }
+            if (word & I2C_IC_DATA_CMD_STOP_BITS)
+                i2c_length = 0;
+        }
+        else
+            write_word(dst, ch->config.size, word);
+
+        if (ch->config.read_increment)
+            src += step;
+        if (ch->config.write_increment)
+            dst += step;
+    }
+
+    if (ch->irq0_enabled)
+    {
+        ch->irq0_status = true;
+        sim_irq_raise(DMA_IRQ_0);
+    }
+}
+
+int dma_claim_unused_channel(bool required)
+{
+    for (int channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (!channels[channel].claimed)
+        {
+            channels[channel].claimed = true;
+            return channel;
+        }
+    }
+
+    assert(!required);
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    (void)channel;
+    return (dma_channel_config){.size = DMA_SIZE_32, .read_increment = true, .write_increment = false};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->write_increment = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    c->dreq = dreq;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    channels[channel].config = *config;
+    channels[channel].write_addr = write_addr;
+    channels[channel].read_addr = read_addr;
+    channels[channel].transfer_count = transfer_count;
+
+    if (trigger)
+        dma_run(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+    channels[channel].read_addr = read_addr;
+    channels[channel].transfer_count = transfer_count;
+    dma_run(channel);
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    channels[channel].irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    return channels[channel].irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    channels[channel].irq0_status = false;
+}
+
+// A transferência já terminou ou ficou parada no disparo: não há o que interromper
+void dma_channel_abort(uint channel)
+{
+    (void)channel;
+}
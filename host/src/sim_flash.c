@@ -0,0 +1,67 @@
+#include <string.h>
+#include "sim.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+uint8_t sim_flash_memory[PICO_FLASH_SIZE_BYTES];
+
+static FILE *flash_file = NULL;
+
+// Imagem inteira da flash, para que o arquivo também possa ser comparado com um dump da placa
+bool sim_flash_open(const char *path)
+{
+    memset(sim_flash_memory, 0xFF, sizeof(sim_flash_memory));
+
+    flash_file = fopen(path, "r+b");
+    if (flash_file != NULL)
+    {
+        size_t read = fread(sim_flash_memory, 1, sizeof(sim_flash_memory), flash_file);
+        (void)read; // Arquivo menor: o restante continua apagado
+        return true;
+    }
+
+    flash_file = fopen(path, "w+b");
+    if (flash_file == NULL)
+        return false;
+
+    fwrite(sim_flash_memory, 1, sizeof(sim_flash_memory), flash_file);
+    fflush(flash_file);
+    return true;
+}
+
+static void flash_sync(uint32_t offset, size_t count)
+{
+    if (flash_file == NULL)
+        return;
+
+    fseek(flash_file, offset, SEEK_SET);
+    fwrite(sim_flash_memory + offset, 1, count, flash_file);
+    fflush(flash_file);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    assert(flash_offs % FLASH_SECTOR_SIZE == 0 && count % FLASH_SECTOR_SIZE == 0);
+    assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+
+    memset(sim_flash_memory + flash_offs, 0xFF, count);
+    flash_sync(flash_offs, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    assert(flash_offs % FLASH_PAGE_SIZE == 0 && count % FLASH_PAGE_SIZE == 0);
+    assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+
+    for (size_t i = 0; i < count; i++)
+        sim_flash_memory[flash_offs + i] &= data[i];
+
+    flash_sync(flash_offs, count);
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+    (void)enter_exit_timeout_ms;
+    func(param);
+    return PICO_OK;
+}
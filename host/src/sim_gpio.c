@@ -0,0 +1,207 @@
+#include <string.h>
+#include "sim.h"
+#include "hardware/gpio.h"
+#include "matrixkey.h"
+
+// Pinos dos botões ligados ao keypad_add_button em main.c (ativos em nível baixo)
+#define SIM_BTN_A 5
+#define SIM_BTN_B 6
+
+#define SIM_GND -1
+
+extern const uint8_t ROW_PINS[ROWS_SIZE];
+extern const uint8_t COL_PINS[COLS_SIZE];
+extern const char keyboard_map[ROWS_SIZE][COLS_SIZE];
+
+typedef struct
+{
+    bool out;       // Direção
+    bool pwm;       // Função PWM: o valor vem de sim_pwm.c
+    bool value;     // Valor escrito por gpio_put
+    bool pull_up;
+    bool level;     // Nível atual do pino
+    uint32_t irq_enabled;
+    uint32_t irq_pending; // Bordas registradas e ainda não reconhecidas, como no INTR do RP2040
+} sim_pin_t;
+
+// Cada chave fechada liga dois pinos (tecla da matriz) ou um pino ao GND (botão)
+typedef struct
+{
+    char key;
+    int a;
+    int b;
+    bool closed;
+} sim_switch_t;
+
+static sim_pin_t pins[NUM_BANK0_GPIOS];
+static sim_switch_t switches[ROWS_SIZE * COLS_SIZE + 2];
+static int switch_count = 0;
+static gpio_irq_callback_t irq_callback = NULL;
+static bool in_irq = false;
+
+static void sim_switches_init()
+{
+    if (switch_count > 0)
+        return;
+
+    for (int r = 0; r < ROWS_SIZE; r++)
+        for (int c = 0; c < COLS_SIZE; c++)
+            switches[switch_count++] = (sim_switch_t){keyboard_map[r][c], ROW_PINS[r], COL_PINS[c], false};
+
+    switches[switch_count++] = (sim_switch_t){'A', SIM_BTN_A, SIM_GND, false};
+    switches[switch_count++] = (sim_switch_t){'B', SIM_BTN_B, SIM_GND, false};
+}
+
+// Uma entrada vai a zero se uma chave fechada a liga ao GND ou a uma saída em nível baixo; senão fica no pull-up
+static bool input_level(int gpio)
+{
+    for (int s = 0; s < switch_count; s++)
+    {
+        if (!switches[s].closed)
+            continue;
+
+        int other = switches[s].a == gpio ? switches[s].b : switches[s].b == gpio ? switches[s].a : -2;
+        if (other == SIM_GND || (other >= 0 && pins[other].out && !pins[other].value))
+            return false;
+    }
+
+    return pins[gpio].pull_up;
+}
+
+// Recalcula os níveis, registra as bordas e chama o callback das habilitadas (na task que causou a mudança)
+void sim_gpio_update()
+{
+    sim_switches_init();
+
+    for (int gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++)
+    {
+        sim_pin_t *pin = &pins[gpio];
+        bool level = pin->out ? pin->value : input_level(gpio);
+
+        if (pin->level && !level)
+            pin->irq_pending |= GPIO_IRQ_EDGE_FALL;
+        if (!pin->level && level)
+            pin->irq_pending |= GPIO_IRQ_EDGE_RISE;
+        pin->level = level;
+    }
+
+    if (in_irq || irq_callback == NULL)
+        return;
+
+    in_irq = true;
+    for (int gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++)
+    {
+        uint32_t events = pins[gpio].irq_pending & pins[gpio].irq_enabled;
+        if (events)
+        {
+            pins[gpio].irq_pending &= ~events;
+            irq_callback(gpio, events);
+        }
+    }
+    in_irq = false;
+}
+
+bool sim_key_set(char key, bool pressed)
+{
+    sim_switches_init();
+
+    for (int s = 0; s < switch_count; s++)
+    {
+        if (switches[s].key == key)
+        {
+            switches[s].closed = pressed;
+            sim_gpio_update();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool sim_gpio_level(uint gpio)
+{
+    return gpio < NUM_BANK0_GPIOS && pins[gpio].level;
+}
+
+void gpio_init(uint gpio)
+{
+    pins[gpio].out = false;
+    pins[gpio].pwm = false;
+    pins[gpio].value = false;
+    sim_gpio_update();
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    pins[gpio].out = out;
+    sim_gpio_update();
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    pins[gpio].value = value;
+    sim_gpio_update();
+}
+
+bool gpio_get(uint gpio)
+{
+    return pins[gpio].level;
+}
+
+void gpio_pull_up(uint gpio)
+{
+    pins[gpio].pull_up = true;
+    sim_gpio_update();
+}
+
+void gpio_pull_down(uint gpio)
+{
+    pins[gpio].pull_up = false;
+    sim_gpio_update();
+}
+
+void gpio_disable_pulls(uint gpio)
+{
+    pins[gpio].pull_up = false;
+    sim_gpio_update();
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    pins[gpio].pwm = fn == GPIO_FUNC_PWM;
+    if (pins[gpio].pwm)
+        pins[gpio].out = true;
+    sim_gpio_update();
+}
+
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive)
+{
+    (void)gpio;
+    (void)drive;
+}
+
+bool sim_gpio_is_pwm(uint gpio)
+{
+    return gpio < NUM_BANK0_GPIOS && pins[gpio].pwm;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+    if (enabled)
+        pins[gpio].irq_enabled |= event_mask;
+    else
+        pins[gpio].irq_enabled &= ~event_mask;
+
+    sim_gpio_update();
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    irq_callback = callback;
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask)
+{
+    pins[gpio].irq_pending &= ~event_mask;
+}
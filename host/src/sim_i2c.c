@@ -0,0 +1,319 @@
+#include <string.h>
+#include "sim.h"
+#include "hardware/i2c.h"
+#include "ssd1306_i2c.h"
+#include "ssd1306_font.h"
+
+// Modelo do SSD1306: um painel em cada bloco i2c interpreta os bytes de controle, comandos e dados de cada
+// transação e mantém a GDDRAM (8 páginas x 128 colunas). A altura vem do multiplex configurado; o roteiro
+// consulta o painel do i2c1
+
+static i2c_hw_t i2c0_hw;
+static i2c_hw_t i2c1_hw;
+i2c_inst_t i2c0_inst = {.hw = &i2c0_hw};
+i2c_inst_t i2c1_inst = {.hw = &i2c1_hw};
+
+sim_i2c_stats_t sim_i2c_stats;
+
+static struct
+{
+    int naks;
+    bool hang;
+} fault;
+
+typedef struct
+{
+    uint8_t gddram[ssd1306_max_pages][ssd1306_max_width];
+    uint8_t height; // Multiplex + 1
+    uint8_t mode; // 0: horizontal, 1: vertical, 2: página
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    bool on;
+    uint8_t contrast;
+    uint8_t start_line;
+    bool inverted;
+    bool scrolling;
+    uint8_t scroll_start, scroll_end; // Páginas roladas
+    uint8_t command;  // Comando aguardando argumentos
+    uint8_t args[6];
+    int nargs, needed;
+} sim_panel_t;
+
+#define SIM_PANEL_RESET {.height = ssd1306_max_height, .mode = 2, .col_end = ssd1306_max_width - 1, \
+                         .page_end = ssd1306_max_pages - 1}
+
+static sim_panel_t panels[2] = {SIM_PANEL_RESET, SIM_PANEL_RESET};
+
+// Número de bytes de argumento de cada comando
+static int command_args(uint8_t command)
+{
+    switch (command)
+    {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void panel_execute(sim_panel_t *panel)
+{
+    uint8_t c = panel->command;
+
+    if (c == 0x20)
+        panel->mode = panel->args[0] & 0x03;
+    else if (c == 0x21)
+    {
+        panel->col_start = panel->col = panel->args[0] & 0x7F;
+        panel->col_end = panel->args[1] & 0x7F;
+    }
+    else if (c == 0x22)
+    {
+        panel->page_start = panel->page = panel->args[0] & 0x07;
+        panel->page_end = panel->args[1] & 0x07;
+    }
+    else if (c == 0xA8)
+        panel->height = (panel->args[0] & 0x3F) + 1;
+    else if (c == 0x81)
+        panel->contrast = panel->args[0];
+    else if (c == 0xAE || c == 0xAF)
+        panel->on = c & 0x01;
+    else if (c >= 0x40 && c <= 0x7F)
+        panel->start_line = c & 0x3F;
+    else if (c == 0xA6 || c == 0xA7)
+        panel->inverted = c & 0x01;
+    else if (c == 0x26 || c == 0x27)
+    {
+        panel->scroll_start = panel->args[1] & 0x07;
+        panel->scroll_end = panel->args[3] & 0x07;
+    }
+    else if (c == 0x2F)
+        panel->scrolling = true;
+    else if (c == 0x2E && panel->scrolling)
+    {
+        // O painel para com as páginas deslocadas; uma coluna basta para que um reenvio esquecido apareça
+        for (int page = panel->scroll_start; page <= panel->scroll_end; page++)
+        {
+            uint8_t first = panel->gddram[page][0];
+            memmove(panel->gddram[page], panel->gddram[page] + 1, ssd1306_max_width - 1);
+            panel->gddram[page][ssd1306_max_width - 1] = first;
+        }
+        panel->scrolling = false;
+    }
+    else if (c <= 0x0F)
+        panel->col = (panel->col & 0xF0) | c;
+    else if (c <= 0x1F)
+        panel->col = (panel->col & 0x0F) | ((c & 0x07) << 4);
+    else if (c >= 0xB0 && c <= 0xB7)
+        panel->page = c & 0x07;
+}
+
+static void panel_command(sim_panel_t *panel, uint8_t byte)
+{
+    if (panel->needed > 0)
+    {
+        panel->args[panel->nargs++] = byte;
+        if (panel->nargs == panel->needed)
+        {
+            panel->needed = 0;
+            panel_execute(panel);
+        }
+        return;
+    }
+
+    panel->command = byte;
+    panel->nargs = 0;
+    panel->needed = command_args(byte);
+    if (panel->needed == 0)
+        panel_execute(panel);
+}
+
+static void panel_data(sim_panel_t *panel, uint8_t byte)
+{
+    panel->gddram[panel->page][panel->col] = byte;
+
+    if (panel->mode == 2)
+    {
+        panel->col = (panel->col + 1) % ssd1306_max_width;
+        return;
+    }
+
+    if (panel->mode == 0)
+    {
+        if (panel->col++ == panel->col_end)
+        {
+            panel->col = panel->col_start;
+            panel->page = panel->page == panel->page_end ? panel->page_start : panel->page + 1;
+        }
+    }
+    else if (panel->page++ == panel->page_end)
+    {
+        panel->page = panel->page_start;
+        panel->col = panel->col == panel->col_end ? panel->col_start : panel->col + 1;
+    }
+}
+
+void sim_i2c_fault(int naks, bool hang)
+{
+    fault.naks = naks;
+    fault.hang = hang;
+}
+
+uint sim_i2c_khz()
+{
+    return i2c1->baudrate / 1000;
+}
+
+// Cada byte de controle define se o que segue é comando (D/C# = 0) ou dado (D/C# = 1), e se vale só
+// para o próximo byte (Co = 1) ou para o resto da transação (Co = 0). Retorna PICO_OK, PICO_ERROR_GENERIC
+// (NACK: endereço errado ou falha injetada) ou PICO_ERROR_TIMEOUT (barramento preso). As falhas só
+// atingem o i2c1
+int sim_i2c_transaction(i2c_inst_t *i2c, uint8_t address, const uint8_t *data, size_t length)
+{
+    sim_panel_t *panel = &panels[i2c_hw_index(i2c)];
+    size_t i = 0;
+    int result = PICO_OK;
+
+    if (address != ssd1306_i2c_address)
+        return PICO_ERROR_GENERIC;
+    if (i2c == i2c1 && fault.hang)
+        return PICO_ERROR_TIMEOUT;
+    if (i2c == i2c1 && fault.naks > 0)
+    {
+        fault.naks--;
+        length /= 2;
+        result = PICO_ERROR_GENERIC;
+    }
+
+    sim_i2c_stats.transactions++;
+    sim_i2c_stats.bytes += length;
+
+    while (i < length)
+    {
+        uint8_t control = data[i++];
+        bool is_data = control & 0x40;
+        size_t end = (control & 0x80) ? MIN(i + 1, length) : length;
+
+        for (; i < end; i++)
+        {
+            if (is_data)
+                panel_data(panel, data[i]);
+            else
+                panel_command(panel, data[i]);
+        }
+    }
+
+    return result;
+}
+
+// Como o reset do bloco: TAR e o abort registrado voltam ao padrão
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->hw->enable = 1;
+    i2c->hw->tar = 0x55;
+    i2c->hw->raw_intr_stat = 0;
+    i2c->hw->status = I2C_IC_STATUS_TFE_BITS;
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+// A recuperação do barramento começa desligando o bloco e termina com os pulsos em SCL: o painel preso
+// solta SDA
+void i2c_deinit(i2c_inst_t *i2c)
+{
+    i2c->hw->enable = 0;
+    if (i2c == i2c1)
+        fault.hang = false;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+// Só o display responde; para os demais endereços a escrita falha como um NACK. O barramento preso faz a
+// escrita esgotar o tempo (a bloqueante ficaria presa para sempre na placa)
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us)
+{
+    (void)nostop;
+    (void)timeout_us;
+
+    int result = sim_i2c_transaction(i2c, addr, src, len);
+    return result == PICO_OK ? (int)len : result;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    return i2c_write_timeout_us(i2c, addr, src, len, nostop, 0);
+}
+
+bool sim_display_pixel(int x, int y)
+{
+    return (panels[1].gddram[y / 8][x] >> (y % 8)) & 1;
+}
+
+bool sim_display_on()
+{
+    return panels[1].on;
+}
+
+uint8_t sim_display_contrast()
+{
+    return panels[1].contrast;
+}
+
+bool sim_display_scrolling()
+{
+    return panels[1].scrolling;
+}
+
+// Glifo 8x8 de um caractere como o driver o desenha: fora do ASCII, o glifo em branco
+static const uint8_t *sim_glyph(char c)
+{
+    uint8_t code = (uint8_t)c;
+    return ssd1306_font_8x8.glyphs + (code < 128 ? ssd1306_font_8x8.index[code] : 0) * 8;
+}
+
+// Procura o texto como desenhado por ssd1306_draw_string: glifos de 8 colunas numa mesma página
+bool sim_display_contains(const char *text)
+{
+    const sim_panel_t *panel = &panels[1];
+    int length = strlen(text);
+
+    if (length == 0 || length * 8 > ssd1306_max_width)
+        return length == 0;
+
+    for (int page = 0; page < panel->height / 8; page++)
+    {
+        for (int x = 0; x + length * 8 <= ssd1306_max_width; x++)
+        {
+            int i = 0;
+            while (i < length && memcmp(&panel->gddram[page][x + i * 8], sim_glyph(text[i]), 8) == 0)
+                i++;
+
+            if (i == length)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// Imprime o painel como visto: com a linha inicial e a inversão aplicadas sobre a GDDRAM
+void sim_display_dump(FILE *out)
+{
+    const sim_panel_t *panel = &panels[1];
+
+    for (int y = 0; y < panel->height; y++)
+    {
+        for (int x = 0; x < ssd1306_max_width; x++)
+            fputc(sim_display_pixel(x, (y + panel->start_line) % panel->height) != panel->inverted ? '#' : '.', out);
+        fputc('\n', out);
+    }
+}
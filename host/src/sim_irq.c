@@ -0,0 +1,37 @@
+#include "sim.h"
+#include "hardware/irq.h"
+
+#define SIM_IRQ_HANDLERS 4
+
+static irq_handler_t irq_handlers[NUM_IRQS][SIM_IRQ_HANDLERS];
+static bool irq_enabled[NUM_IRQS];
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+    (void)order_priority;
+
+    for (int i = 0; i < SIM_IRQ_HANDLERS; i++)
+    {
+        if (irq_handlers[num][i] == NULL)
+        {
+            irq_handlers[num][i] = handler;
+            return;
+        }
+    }
+
+    assert(false);
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    irq_enabled[num] = enabled;
+}
+
+void sim_irq_raise(uint num)
+{
+    if (!irq_enabled[num])
+        return;
+
+    for (int i = 0; i < SIM_IRQ_HANDLERS && irq_handlers[num][i] != NULL; i++)
+        irq_handlers[num][i]();
+}
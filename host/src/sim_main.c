@@ -0,0 +1,229 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "trace.h"
+
+// Driver da simulação: carrega a flash, cria a task que executa o roteiro e entra no main() do firmware
+// (compilado como firmware_main). Comandos do roteiro, um por linha ('#' inicia comentário):
+//   type <teclas>         pressiona e solta cada tecla ('0'..'9', '*', '#', 'A', 'B')
+//   hold <tecla>          mantém a tecla pressionada
+//   release <tecla>       solta a tecla
+//   wait <ms>             espera o tempo simulado
+//   expect <texto>        espera o texto aparecer no display
+//   level <gpio> <0|1>    espera o nível do pino (LEDs, buzzer)
+//   dump                  imprime o display
+//   panel <on|off>        espera o painel ligar ou desligar
+//   contrast <valor>      espera o brilho do painel (0..255)
+//   scroll <on|off>       espera o scroll horizontal do painel começar ou parar
+//   i2c nak <n>           as próximas n transações do display recebem NACK no meio
+//   i2c hang              prende o barramento do display até a recuperação
+//   i2c <kHz>             espera o clock do barramento do display
+//   trace                 imprime os eventos rastreados no formato do Chrome trace (com TRACE_ENABLED)
+
+#define SIM_TASK_PRIORITY 1
+#define SIM_TASK_STACK 2048
+#define SIM_KEY_HOLD_MS 30
+#define SIM_KEY_GAP_MS 30
+#define SIM_EXPECT_TIMEOUT_MS 5000
+#define SIM_LINE_SIZE 128
+#define SIM_MAX_LINES 1024
+
+int firmware_main(void);
+
+static char script[SIM_MAX_LINES][SIM_LINE_SIZE];
+static int script_lines = 0;
+static int runs = 1;
+
+static void sim_fail(int run, int line, const char *message)
+{
+    fprintf(stderr, "sim: run %d, line %d: %s: %s\n", run + 1, line + 1, message, script[line]);
+    sim_display_dump(stderr);
+    exit(1);
+}
+
+static bool sim_key(char key, bool pressed)
+{
+    if (!sim_key_set(key, pressed))
+        return false;
+
+    vTaskDelay(pdMS_TO_TICKS(pressed ? SIM_KEY_HOLD_MS : SIM_KEY_GAP_MS));
+    return true;
+}
+
+static bool sim_level_is(uint gpio, bool level)
+{
+    return sim_gpio_level(gpio) == level;
+}
+
+// Espera até SIM_EXPECT_TIMEOUT_MS pela condição, verificando a cada milissegundo simulado
+#define SIM_WAIT_FOR(condition)                                                 \
+    ({                                                                          \
+        int elapsed = 0;                                                        \
+        while (!(condition) && elapsed++ < SIM_EXPECT_TIMEOUT_MS)               \
+            vTaskDelay(pdMS_TO_TICKS(1));                                       \
+        (condition);                                                            \
+    })
+
+static bool sim_run_line(const char *line)
+{
+    char command[16] = {0};
+    int skip = 0;
+
+    if (line[0] == '\0' || line[0] == '#')
+        return true;
+
+    sscanf(line, "%15s %n", command, &skip);
+    const char *arg = line + skip;
+
+    if (strcmp(command, "type") == 0)
+    {
+        for (; *arg; arg++)
+            if (!sim_key(*arg, true) || !sim_key(*arg, false))
+                return false;
+        return true;
+    }
+    if (strcmp(command, "hold") == 0)
+        return sim_key(arg[0], true);
+    if (strcmp(command, "release") == 0)
+        return sim_key(arg[0], false);
+    if (strcmp(command, "wait") == 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(atoi(arg)));
+        return true;
+    }
+    if (strcmp(command, "expect") == 0)
+        return SIM_WAIT_FOR(sim_display_contains(arg));
+    if (strcmp(command, "level") == 0)
+    {
+        uint gpio;
+        int level;
+        if (sscanf(arg, "%u %d", &gpio, &level) != 2)
+            return false;
+        return SIM_WAIT_FOR(sim_level_is(gpio, level));
+    }
+    if (strcmp(command, "panel") == 0)
+    {
+        bool on = strcmp(arg, "on") == 0;
+        if (!on && strcmp(arg, "off") != 0)
+            return false;
+        return SIM_WAIT_FOR(sim_display_on() == on);
+    }
+    if (strcmp(command, "contrast") == 0)
+    {
+        unsigned contrast;
+        if (sscanf(arg, "%u", &contrast) != 1)
+            return false;
+        return SIM_WAIT_FOR(sim_display_contrast() == contrast);
+    }
+    if (strcmp(command, "scroll") == 0)
+    {
+        bool on = strcmp(arg, "on") == 0;
+        if (!on && strcmp(arg, "off") != 0)
+            return false;
+        return SIM_WAIT_FOR(sim_display_scrolling() == on);
+    }
+    if (strcmp(command, "i2c") == 0)
+    {
+        int naks;
+        unsigned khz;
+        if (sscanf(arg, "nak %d", &naks) == 1)
+            sim_i2c_fault(naks, false);
+        else if (strcmp(arg, "hang") == 0)
+            sim_i2c_fault(0, true);
+        else if (sscanf(arg, "%u", &khz) == 1)
+            return SIM_WAIT_FOR(sim_i2c_khz() == khz);
+        else
+            return false;
+        return true;
+    }
+    if (strcmp(command, "dump") == 0)
+    {
+        sim_display_dump(stdout);
+        return true;
+    }
+#if TRACE_ENABLED
+    if (strcmp(command, "trace") == 0)
+    {
+        trace_dump_chrome();
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+static void task_sim(void *params)
+{
+    for (int run = 0; run < runs; run++)
+        for (int line = 0; line < script_lines; line++)
+            if (!sim_run_line(script[line]))
+                sim_fail(run, line, "failed");
+
+    printf("sim: %d run(s) ok, %llu ms simulated\n", runs, (unsigned long long)(time_us_64() / 1000));
+    exit(0);
+}
+
+static bool load_script(FILE *file)
+{
+    while (script_lines < SIM_MAX_LINES && fgets(script[script_lines], SIM_LINE_SIZE, file))
+    {
+        char *line = script[script_lines];
+        line[strcspn(line, "\r\n")] = '\0';
+        script_lines++;
+    }
+
+    return feof(file);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-f flash.bin] [-n runs] [-s seed] [script]\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *flash_path = "vault-flash.bin";
+    unsigned seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:n:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f':
+            flash_path = optarg;
+            break;
+        case 'n':
+            runs = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    FILE *file = optind < argc ? fopen(argv[optind], "r") : stdin;
+    if (file == NULL || !load_script(file))
+    {
+        fprintf(stderr, "sim: cannot read script\n");
+        return 2;
+    }
+
+    if (!sim_flash_open(flash_path))
+    {
+        fprintf(stderr, "sim: cannot open %s\n", flash_path);
+        return 2;
+    }
+
+    srand(seed);
+    xTaskCreate(task_sim, "Sim Task", SIM_TASK_STACK, NULL, SIM_TASK_PRIORITY, NULL);
+
+    return firmware_main();
+}
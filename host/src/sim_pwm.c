@@ -0,0 +1,40 @@
+#include "sim.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+
+#define SIM_PWM_SLICES 8
+
+static bool slice_enabled[SIM_PWM_SLICES];
+static uint16_t gpio_level[NUM_BANK0_GPIOS];
+
+// O nível visto pelo roteiro acompanha a saída do PWM: alto com o slice ligado e ciclo maior que zero
+static void sim_pwm_update(uint slice_num)
+{
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++)
+        if (pwm_gpio_to_slice_num(gpio) == slice_num && sim_gpio_is_pwm(gpio))
+            gpio_put(gpio, slice_enabled[slice_num] && gpio_level[gpio] > 0);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider)
+{
+    (void)slice_num;
+    (void)divider;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap)
+{
+    (void)slice_num;
+    (void)wrap;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+    gpio_level[gpio] = level;
+    sim_pwm_update(pwm_gpio_to_slice_num(gpio));
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled)
+{
+    slice_enabled[slice_num] = enabled;
+    sim_pwm_update(slice_num);
+}
@@ -0,0 +1,94 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include "sim.h"
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "pico/bootrom.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+void stdio_init_all()
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    (void)timeout_us;
+    return PICO_ERROR_TIMEOUT;
+}
+
+int stdio_put_string(const char *s, int len, bool newline, bool cr_translation)
+{
+    (void)cr_translation;
+    fwrite(s, 1, len, stdout);
+    if (newline)
+        putchar('\n');
+    return len;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param)
+{
+    (void)fn;
+    (void)param;
+}
+
+// Um tick do FreeRTOS é um milissegundo simulado; antes do escalonador o tempo está parado
+uint64_t time_us_64()
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+        return 0;
+
+    return (uint64_t)xTaskGetTickCount() * 1000;
+}
+
+uint32_t time_us_32()
+{
+    return (uint32_t)time_us_64();
+}
+
+void sleep_ms(uint32_t ms)
+{
+    (void)ms;
+}
+
+void sleep_us(uint64_t us)
+{
+    (void)us;
+}
+
+void panic(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    fprintf(stderr, "panic: ");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    abort();
+}
+
+// Não há fonte de entropia a emular: a semente vem do processo
+void get_rand_128(rng_128_t *rand128)
+{
+    rand128->r[0] = get_rand_64();
+    rand128->r[1] = get_rand_64();
+}
+
+uint32_t get_rand_32()
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+uint64_t get_rand_64()
+{
+    return ((uint64_t)get_rand_32() << 32) | get_rand_32();
+}
+
+void reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask)
+{
+    (void)usb_activity_gpio_pin_mask;
+    (void)disable_interface_mask;
+    exit(0);
+}
@@ -41,8 +41,12 @@
  *----------------------------------------------------------*/
 
 /* Scheduler Related */
+/* LOW_POWER: sem task pronta o kernel suspende o tick e dorme em WFI até a próxima interrupção (ver power.c) */
+#ifndef LOW_POWER
+#define LOW_POWER                               0
+#endif
 #define configUSE_PREEMPTION                    1
-#define configUSE_TICKLESS_IDLE                 0
+#define configUSE_TICKLESS_IDLE                 LOW_POWER
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -76,14 +80,29 @@
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
-#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configCHECK_FOR_STACK_OVERFLOW          2
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+/* Contadores de tempo de execução em microssegundos, lidos do timer do RP2040 (ver diagnostics.c) */
+#define configGENERATE_RUN_TIME_STATS           1
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
+#if !defined(__ASSEMBLER__)
+extern uint64_t time_us_64(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        time_us_64()
+
+/* Medição do tempo dormindo no tickless idle */
+#if LOW_POWER && !defined(__ASSEMBLER__)
+extern void power_sleep_enter(void);
+extern void power_sleep_exit(void);
+#define configPRE_SLEEP_PROCESSING( x )         power_sleep_enter()
+#define configPOST_SLEEP_PROCESSING( x )        power_sleep_exit()
+#endif
 
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES                   0
@@ -102,13 +121,23 @@
 #define configMAX_API_CALL_INTERRUPT_PRIORITY   [dependent on processor and application]
 */
 
-// #if FREE_RTOS_KERNEL_SMP // set by the RP2040 SMP port of FreeRTOS
-// /* SMP port only */
-// #define configNUMBER_OF_CORES                   2
-// #define configTICK_CORE                         0
-// #define configRUN_MULTIPLE_PRIORITIES           1
-// #define configUSE_CORE_AFFINITY                 1
-// #endif
+/* SMP: DUAL_CORE roda o kernel nos dois núcleos; o display fica no núcleo 1 e o resto no núcleo 0 */
+#ifndef DUAL_CORE
+#define DUAL_CORE                               0
+#endif
+#if DUAL_CORE
+#if LOW_POWER
+#error "o tickless idle do port RP2040 não funciona com SMP: use LOW_POWER ou DUAL_CORE"
+#endif
+#define configNUMBER_OF_CORES                   2
+#define configTICK_CORE                         0
+#define configRUN_MULTIPLE_PRIORITIES           1
+#define configUSE_CORE_AFFINITY                 1
+#define configUSE_PASSIVE_IDLE_HOOK             0
+#define configTIMER_SERVICE_TASK_CORE_AFFINITY  ( 1 << 0 ) /* Varredura do teclado e feedback junto da interface */
+#else
+#define configNUMBER_OF_CORES                   1
+#endif
 
 /* RP2040 specific */
 #define configSUPPORT_PICO_SYNC_INTEROP         1
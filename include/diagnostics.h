@@ -0,0 +1,15 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define DIAG_TASK_PRIORITY 1
+#define DIAG_TASK_STACK 1024
+#define DIAG_MAX_TASKS 16
+
+void diag_init(uint32_t period_ms);
+void diag_report();
+
+#endif
@@ -4,10 +4,46 @@
 #include "pico/stdlib.h"
 #include "ssd1306.h"
 #include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
 
 #define DIGIT_SPACING 8
 
-void draw_pswd(uint8_t *ssd, size_t ssd_len, struct render_area *frame, char *pswd, uint8_t pswd_len, int16_t x, int16_t y, bool visible);
+#define DISPLAY_TASK_PRIORITY 3
+#define DISPLAY_TASK_STACK 1024
+#define DISPLAY_TASK_CORE 1 // Com DUAL_CORE, o envio ao display (i2c e DMA) fica sozinho no núcleo 1
 
+#define DISPLAY_CONTRAST_ON 0xFF
+#define DISPLAY_CONTRAST_DIM 0x08
+
+#define DISPLAY_CURSOR_MS 500   // Meio período do cursor piscante
+#define DISPLAY_MARQUEE_PAGE 4  // Página rolada por DISPLAY_ANIM_MARQUEE: a linha das mensagens (y = 32)
+
+typedef enum
+{
+    DISPLAY_POWER_ON,
+    DISPLAY_POWER_DIM, // Brilho reduzido
+    DISPLAY_POWER_OFF, // Painel desligado; o conteúdo volta ao religar
+} display_power_t;
+
+// Animações feitas só com comandos ao SSD1306 (brilho, linha inicial, inversão e scroll), sem reenviar a tela
+typedef enum
+{
+    DISPLAY_ANIM_FADE_IN, // Brilho sobe do apagado ao atual
+    DISPLAY_ANIM_ROLL_IN, // A tela entra rolando na vertical
+    DISPLAY_ANIM_SHAKE,   // A tela sacode na vertical
+    DISPLAY_ANIM_FLASH,   // A tela pisca invertida
+    DISPLAY_ANIM_MARQUEE, // A linha das mensagens rola na horizontal até o próximo quadro
+    DISPLAY_ANIM_COUNT,
+} display_anim_t;
+
+ssd1306_t *display_init(ssd1306_t *oled);
+void display_begin();
+void display_commit();
+void display_release();
+void display_set_power(display_power_t power);
+void display_animate(display_anim_t anim);
+bool display_set_cursor(int x, int y, int width, int height);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "timers.h"
+
+// Duração das mensagens na tela e do clique das teclas (a simulação no host encurta as mensagens)
+#ifndef UI_MESSAGE_MS
+#define UI_MESSAGE_MS 1500
+#endif
+#ifndef UI_CLICK_MS
+#define UI_CLICK_MS 100
+#endif
+
+#define FEEDBACK_PWM_CLOCK_HZ 1000000 // Contador do PWM do buzzer: tons de 16 Hz para cima
+
+// LEDs acesos em cada passo de um padrão
+#define FEEDBACK_RED (1u << 0)
+#define FEEDBACK_GREEN (1u << 1)
+#define FEEDBACK_BLUE (1u << 2)
+
+typedef enum
+{
+    FEEDBACK_BOOT,    // Verde, sem som
+    FEEDBACK_CLICK,   // Tecla aceita
+    FEEDBACK_SUCCESS, // Senha salva ou acesso liberado
+    FEEDBACK_DENIED,  // Senha errada ou confirmação diferente
+    FEEDBACK_LOCKOUT, // Tentativas esgotadas: o vermelho fica aceso
+    FEEDBACK_LOCKED,  // Cofre bloqueado pelo usuário
+    FEEDBACK_RESET,   // Senhas apagadas
+    FEEDBACK_PATTERN_COUNT,
+} feedback_pattern_t;
+
+void feedback_init(uint red_gpio, uint green_gpio, uint blue_gpio, uint buzzer_gpio);
+void feedback_play(feedback_pattern_t pattern);
+
+#endif
@@ -4,15 +4,81 @@
 #include "pico/stdlib.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
+#include "pico/flash.h"
 #include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
 
-#define FLASH_TARGET_OFFSET 0x1F000
-#define FLASH_SIZE 4096
-#define PASSWORD_SIZE 6
+// Senhas de PSWD_MIN_LEN a PSWD_MAX_LEN dígitos, uma por usuário; o usuário é o índice direto na tabela.
+// No máximo 9 usuários, escolhidos no teclado pelas teclas 1 a 9
+#define PSWD_MIN_LEN 4
+#define PSWD_MAX_LEN 16
+#ifndef PSWD_USER_SLOTS
+#define PSWD_USER_SLOTS 4
+#endif
 
-void flash_write_pswd(const char *password, size_t length);
-void flash_erase_pswd(size_t length);
-bool flash_pswd_exists(const uint8_t *flash_pswd);
-bool pswd_matches(const char *input_pswd, const uint8_t *flash_pswd);
+// Região do registro de credenciais: FLASH_STORE_SECTORS setores no fim da flash, usados como um log circular
+#ifndef FLASH_STORE_SECTORS
+#define FLASH_STORE_SECTORS 8
+#endif
+#ifndef FLASH_STORE_OFFSET
+#define FLASH_STORE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#endif
+
+#define FLASH_TASK_PRIORITY 1
+#define FLASH_TASK_STACK 1024
+#define FLASH_TASK_CORE 0
+#define FLASH_QUEUE_SIZE 4
+#define FLASH_SAFE_TIMEOUT_MS 100 // Espera máxima pelo outro núcleo antes de desistir da operação
+
+#define FLASH_RECORD_SIZE 64
+#define FLASH_RECORD_DATA_SIZE 52
+#define FLASH_RECORD_MAGIC 0xA5
+#define FLASH_RECORDS_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_RECORD_SIZE)
+#define FLASH_STORE_RECORDS (FLASH_STORE_SECTORS * FLASH_RECORDS_PER_SECTOR)
+
+// Derivação da senha: PBKDF2-HMAC-SHA256 com sal aleatório. O número de iterações fica gravado no
+// registro, então alterar PSWD_KDF_ITERATIONS só afeta as próximas senhas
+#ifndef PSWD_KDF_ITERATIONS
+#define PSWD_KDF_ITERATIONS 1000
+#endif
+#define PSWD_KDF_MAX_ITERATIONS 100000 // Limita o tempo de uma verificação mesmo com um registro adulterado
+#define PSWD_SALT_SIZE 16
+#define PSWD_HASH_SIZE 32
+
+// Conteúdo de um registro FLASH_RECORD_PSWD
+typedef struct
+{
+    uint32_t iterations;
+    uint8_t salt[PSWD_SALT_SIZE];
+    uint8_t hash[PSWD_HASH_SIZE];
+} pswd_verifier_t;
+
+// Tipos de registro
+#define FLASH_RECORD_PSWD 0x01
+#define FLASH_RECORD_ERASED 0x02 // Marca a senha do usuário como apagada, sem apagar o setor
+
+// Registro do log: para cada usuário, o de maior sequência com CRC válido é o estado atual
+typedef struct
+{
+    uint8_t magic;
+    uint8_t type;
+    uint8_t user;
+    uint8_t length;
+    uint32_t sequence;
+    uint8_t data[FLASH_RECORD_DATA_SIZE];
+    uint32_t crc; // CRC-32 de todos os campos anteriores
+} flash_record_t;
+
+void flash_pswd_init();
+void flash_service_init();
+void flash_write_pswd(int user, const char *password, size_t length);
+void flash_erase_pswd(int user);
+void flash_erase_all();
+bool flash_pswd_exists(int user);
+int flash_user_count();
+bool pswd_matches(int user, const char *input_pswd);
+void pswd_benchmark(int runs);
 
 #endif
\ No newline at end of file
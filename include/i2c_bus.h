@@ -0,0 +1,50 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+#define I2C_BUS_COUNT 2                // Blocos i2c do RP2040
+#define I2C_BUS_PROBE_WRITES 4         // Escritas seguidas que um clock precisa aceitar na sondagem
+#define I2C_BUS_RETRIES 2              // Novas tentativas de uma escrita que falhou, cada uma após recuperar o barramento
+#define I2C_BUS_TIMEOUT_MARGIN_US 500  // Folga do timeout sobre o dobro do tempo de linha (clock stretching, IRQs)
+#define I2C_BUS_RECOVERY_PULSES 9      // Pulsos de SCL que liberam um escravo preso no meio de um byte
+#define I2C_BUS_RECOVERY_HALF_US 5     // Meio período dos pulsos de recuperação (100 kHz)
+#define I2C_BUS_FIFO_DEPTH 16          // Palavras do FIFO de transmissão que ainda saem depois do fim de um DMA
+
+// Contadores desde a inicialização; a taxa em bytes/s sai da diferença entre duas leituras
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t errors;     // Escritas que falharam (NACK ou timeout), inclusive as recuperadas numa nova tentativa
+    uint32_t timeouts;
+    uint32_t recoveries; // Pulsos de SCL e reinicialização do bloco
+    uint32_t fallbacks;  // Quedas de clock após um erro
+} i2c_bus_stats_t;
+
+// Barramento de um bloco i2c: o clock começa no máximo sondado e desce um degrau a cada erro
+typedef struct i2c_bus
+{
+    i2c_inst_t *i2c;
+    uint sda;
+    uint scl;
+    uint khz;     // Clock atual
+    uint max_khz; // Teto pedido na inicialização
+    i2c_bus_stats_t stats;
+    void (*on_recover)(struct i2c_bus *bus); // Chamada após cada recuperação, antes de uma nova tentativa:
+                                             // ressincroniza o escravo com escritas diretas pelo bloco
+} i2c_bus_t;
+
+i2c_bus_t *i2c_bus_init(i2c_inst_t *i2c, uint sda, uint scl, uint max_khz);
+i2c_bus_t *i2c_bus_get(uint index);
+bool i2c_bus_probe(i2c_bus_t *bus, uint8_t address, const uint8_t *src, size_t len);
+int i2c_bus_write(i2c_bus_t *bus, uint8_t address, const uint8_t *src, size_t len);
+uint32_t i2c_bus_timeout_us(const i2c_bus_t *bus, size_t len);
+bool i2c_bus_idle(const i2c_bus_t *bus);
+bool i2c_bus_wait_idle(const i2c_bus_t *bus, uint32_t timeout_us);
+void i2c_bus_count(i2c_bus_t *bus, uint32_t transactions, uint32_t bytes);
+void i2c_bus_fail(i2c_bus_t *bus, bool timeout);
+void i2c_bus_recover(i2c_bus_t *bus);
+
+#endif
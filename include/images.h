@@ -0,0 +1,11 @@
+#ifndef IMAGES_H
+#define IMAGES_H
+
+#include "ssd1306.h"
+
+// Imagens da interface, geradas no build por tools/assetgen a partir de assets/icons (veja assets/assets.txt).
+// As de 32x32 são comprimidas (o cadeado fechado é só o delta da alça sobre o aberto); asset_images dá acesso
+// a todas pelo índice ASSET_IMAGE_*
+#include "assets.h"
+
+#endif
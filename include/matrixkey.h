@@ -4,20 +4,37 @@
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "timers.h"
 
 #define ROWS_SIZE 4
 #define COLS_SIZE 3
 
+#define KEYPAD_MAX_BUTTONS 4   // Botões avulsos tratados junto com o teclado
+#define KEYPAD_SCAN_MS 5       // Intervalo entre varreduras enquanto há tecla pressionada
+#define KEYPAD_QUEUE_SIZE 16
+
+#ifndef KEYPAD_USE_PIO
+#define KEYPAD_USE_PIO 0       // 1: linhas acionadas e colunas amostradas pela PIO, com DMA num anel
+#endif
+#define KEYPAD_PIO_CLOCK_HZ 1000000 // Clock da máquina de estados: uma varredura a cada ~1 ms
+
 extern const uint8_t ROW_PINS[ROWS_SIZE];
 extern const uint8_t COL_PINS[COLS_SIZE];
 extern const char keyboard_map[ROWS_SIZE][COLS_SIZE];
 
-void init_matrix_keypad();
-char read_digit(const uint8_t *rows, const uint8_t *cols);
-void click_feedback(uint led_gpio, uint buzzer_gpio, uint delay_ms);
+typedef struct
+{
+    char key;         // Caractere do teclado ou código do botão
+    bool pressed;     // true: pressionado, false: solto
+    uint32_t time_us; // Instante da detecção (time_us_32)
+} keypad_event_t;
 
-//bool read_matrix_step(char *pswd, size_t pswd_size, int *idx, uint led_gpio, uint buzzer_gpio);
-
-//void read_matrix(char *pswd, const char *msg, uint led_gpio, uint buzzer_gpio, uint8_t *ssd, bool visible);
+void init_matrix_keypad();
+void keypad_add_button(uint gpio, char key);
+bool keypad_get_event(keypad_event_t *event, TickType_t timeout);
+bool keypad_wait_press(TickType_t timeout);
+uint16_t keypad_get_bitmap();
+bool keypad_ghosted(uint16_t bitmap);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+// Inatividade até reduzir o brilho do display e até desligá-lo (contadas a partir da última tecla)
+#ifndef POWER_DIM_MS
+#define POWER_DIM_MS 15000
+#endif
+#ifndef POWER_OFF_MS
+#define POWER_OFF_MS 60000
+#endif
+
+void power_init();
+bool power_activity();
+void power_hold();
+void power_sleep_stats(uint64_t *asleep_us, uint64_t *uptime_us);
+
+#endif
@@ -1,17 +1,37 @@
 #include "ssd1306_i2c.h"
+#include "ssd1306_font.h"
+extern bool ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_bus_t *bus);
+extern void ssd1306_config(ssd1306_t *ssd);
 extern void calculate_render_area_buffer_length(struct render_area *area);
-extern void ssd1306_send_command(uint8_t cmd);
-extern void ssd1306_send_command_list(uint8_t *ssd, int number);
-extern void ssd1306_send_buffer(uint8_t ssd[], int buffer_length);
-extern void ssd1306_init();
-extern void ssd1306_scroll(bool set);
-extern void render_on_display(uint8_t *ssd, struct render_area *area);
-extern void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set);
-extern void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set);
-extern void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character);
-extern void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string);
 extern void ssd1306_command(ssd1306_t *ssd, uint8_t command);
-extern void ssd1306_config(ssd1306_t *ssd);
-extern void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
-extern void ssd1306_send_data(ssd1306_t *ssd);
-extern void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap);
\ No newline at end of file
+extern void ssd1306_send_command_list(ssd1306_t *ssd, const uint8_t *commands, int number);
+extern void ssd1306_scroll(ssd1306_t *ssd, bool set);
+extern void ssd1306_scroll_pages(ssd1306_t *ssd, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval);
+extern void ssd1306_scroll_stop(ssd1306_t *ssd);
+extern void ssd1306_start_line(ssd1306_t *ssd, uint8_t line);
+extern void ssd1306_invert(ssd1306_t *ssd, bool inverted);
+extern void ssd1306_power(ssd1306_t *ssd, bool on);
+extern void ssd1306_contrast(ssd1306_t *ssd, uint8_t contrast);
+extern void render_on_display(ssd1306_t *ssd, struct render_area *area);
+extern void ssd1306_mark_dirty(ssd1306_t *ssd, int x, int y, int width, int height);
+extern void ssd1306_clear(ssd1306_t *ssd);
+extern void ssd1306_flush(ssd1306_t *ssd);
+extern void ssd1306_dma_init(ssd1306_t *ssd, void (*on_done)(ssd1306_t *ssd));
+extern bool ssd1306_flush_async(ssd1306_t *ssd);
+extern bool ssd1306_flush_done(ssd1306_t *ssd);
+extern uint32_t ssd1306_flush_timeout_us(const ssd1306_t *ssd);
+extern bool ssd1306_flush_end(ssd1306_t *ssd, bool completed);
+extern void ssd1306_set_pixel(ssd1306_t *ssd, int x, int y, bool set);
+extern void ssd1306_draw_line(ssd1306_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set);
+extern void ssd1306_fill_rect(ssd1306_t *ssd, int x, int y, int width, int height, ssd1306_color_t color);
+extern void ssd1306_hline(ssd1306_t *ssd, int x, int y, int width, ssd1306_color_t color);
+extern void ssd1306_vline(ssd1306_t *ssd, int x, int y, int height, ssd1306_color_t color);
+extern void ssd1306_draw_rect(ssd1306_t *ssd, int x, int y, int width, int height, ssd1306_color_t color);
+extern void ssd1306_blit_masked(ssd1306_t *ssd, const uint8_t *image, const uint8_t *mask, int width, int height, int x, int y);
+extern void ssd1306_draw_glyph(ssd1306_t *ssd, const ssd1306_font_t *font, int x, int y, char character);
+extern int ssd1306_draw_text(ssd1306_t *ssd, const ssd1306_font_t *font, int x, int y, const char *string);
+extern void ssd1306_draw_char(ssd1306_t *ssd, int16_t x, int16_t y, uint8_t character);
+extern void ssd1306_draw_string(ssd1306_t *ssd, int16_t x, int16_t y, const char *string);
+extern void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap);
+extern void ssd1306_blit_image(ssd1306_t *ssd, const ssd1306_image_t *image, int x, int page, const struct render_area *clip);
+extern void ssd1306_draw_image(ssd1306_t *ssd, const ssd1306_image_t *image, int x, int page, const struct render_area *clip);
\ No newline at end of file
@@ -1,16 +1,23 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "i2c_bus.h"
 
 #ifndef ssd1306_inc_h
 #define ssd1306_inc_h
 
-#define ssd1306_height 64 // Define a altura do display (32 pixels)
-#define ssd1306_width 128 // Define a largura do display (128 pixels)
+// Geometria máxima: cada ssd1306_t tem a sua largura e altura (128x64 ou 128x32), escolhidas em ssd1306_init
+#define ssd1306_max_height 64
+#define ssd1306_max_width 128
 
-#define ssd1306_i2c_address _u(0x3C) // Define o endereço do i2c do display
+#define ssd1306_max_devices 4 // Painéis inicializados ao mesmo tempo (dois endereços em cada bloco i2c)
 
-#define ssd1306_i2c_clock 400 // Define o tempo do clock (pode ser aumentado)
+#define ssd1306_i2c_address _u(0x3C) // Endereço padrão do display (SA0 em nível baixo)
+#define ssd1306_i2c_address_alt _u(0x3D) // Endereço com SA0 em nível alto
+
+#define ssd1306_i2c_clock 1000 // Clock máximo sondado em ssd1306_init (Fast-mode Plus); cai a cada erro
+
+#define ssd1306_command_batch 32 // Máximo de comandos enviados numa única transação i2c
 
 // Comandos de configuração (endereços)
 #define ssd1306_set_memory_mode _u(0x20)
@@ -19,6 +26,12 @@
 #define ssd1306_set_horizontal_scroll _u(0x26)
 #define ssd1306_set_scroll _u(0x2E)
 
+// Intervalo entre passos do scroll horizontal, em quadros do painel (codificação do datasheet)
+#define ssd1306_scroll_frames_2 _u(0x07)
+#define ssd1306_scroll_frames_5 _u(0x00)
+#define ssd1306_scroll_frames_25 _u(0x06)
+#define ssd1306_scroll_frames_64 _u(0x01)
+
 #define ssd1306_set_display_start_line _u(0x40)
 
 #define ssd1306_set_contrast _u(0x81)
@@ -39,10 +52,14 @@
 #define ssd1306_set_precharge _u(0xD9)
 #define ssd1306_set_common_pin_configuration _u(0xDA)
 #define ssd1306_set_vcomh_deselect_level _u(0xDB)
+#define ssd1306_nop _u(0xE3)
 
 #define ssd1306_page_height _u(8)
-#define ssd1306_n_pages (ssd1306_height / ssd1306_page_height)
-#define ssd1306_buffer_length (ssd1306_n_pages * ssd1306_width)
+#define ssd1306_max_pages (ssd1306_max_height / ssd1306_page_height)
+#define ssd1306_max_buffer_length (ssd1306_max_pages * ssd1306_max_width)
+
+// Palavras do DMA por página: transação de comandos (controle + 6) e de dados (controle + colunas)
+#define ssd1306_dma_words_per_page (1 + 6 + 1 + ssd1306_max_width)
 
 #define ssd1306_write_mode _u(0xFE)
 #define ssd1306_read_mode _u(0xFF)
@@ -56,13 +73,48 @@ struct render_area {
     int buffer_length;
 };
 
-typedef struct {
-  uint8_t width, height, pages, address;
-  i2c_inst_t * i2c_port;
-  bool external_vcc;
-  uint8_t *ram_buffer;
-  size_t bufsize;
-  uint8_t port_buffer[2];
+// Um painel: barramento, endereço, geometria e framebuffer (página por página, width bytes por página).
+// Os buffers têm o tamanho máximo, sem alocação; o que vem depois de buffer é estado interno do driver
+typedef struct ssd1306 {
+    uint8_t width, height, pages, address;
+    i2c_bus_t *bus;
+    bool external_vcc;
+    uint8_t *buffer; // Framebuffer, logo após o byte de controle de dados em ram_buffer
+    size_t bufsize;  // width * pages
+
+    uint8_t ram_buffer[ssd1306_max_buffer_length + 1];
+    uint8_t shadow[ssd1306_max_buffer_length]; // Cópia do conteúdo atual do painel
+    bool shadow_valid;
+    uint8_t dirty_start[ssd1306_max_pages]; // Faixa de colunas [início, fim) alterada em cada página
+    uint8_t dirty_end[ssd1306_max_pages];
+    uint16_t dma_words[ssd1306_max_pages * ssd1306_dma_words_per_page];
+    int dma_words_count;
+    int dma_channel;
+    void (*dma_done)(struct ssd1306 *ssd);
 } ssd1306_t;
 
+// Cor das primitivas de preenchimento: acende, apaga ou inverte os pixels cobertos
+typedef enum {
+    SSD1306_COLOR_BLACK,
+    SSD1306_COLOR_WHITE,
+    SSD1306_COLOR_INVERT, // XOR
+} ssd1306_color_t;
+
+// Formatos de imagem: bytes de coluna com o bit 0 na linha de cima, página por página
+typedef enum {
+    SSD1306_IMAGE_RAW,        // width * pages bytes
+    SSD1306_IMAGE_RLE,        // Blocos: n < 0x80 seguido de n + 1 bytes literais; n >= 0x80 seguido de um byte
+                              // repetido n - 0x7D vezes (3 a 130)
+    SSD1306_IMAGE_PAGE_DELTA, // Trechos {página, coluna, n, n bytes} que diferem da imagem base
+} ssd1306_image_format_t;
+
+typedef struct ssd1306_image {
+    uint8_t width;
+    uint8_t pages;
+    uint8_t format;
+    uint16_t size; // Bytes em data
+    const uint8_t *data;
+    const struct ssd1306_image *base; // SSD1306_IMAGE_PAGE_DELTA: imagem sobre a qual os trechos se aplicam
+} ssd1306_image_t;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Rastreamento de latência (tecla -> feedback -> verificação -> flash -> quadro no display). Com TRACE_ENABLED 0
+// os pontos de rastreamento desaparecem do código
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#define TRACE_RING_SIZE 128 // Eventos por produtor (potência de 2)
+#define TRACE_MAX_RINGS 12  // Produtores: uma ring por task que rastreia e uma por núcleo para interrupções
+#define TRACE_TLS_INDEX 0   // Ponteiro de armazenamento local da task que guarda a sua ring
+#define TRACE_TASK_PRIORITY 1
+#define TRACE_TASK_STACK 1024
+
+typedef enum
+{
+    TRACE_KEY_EDGE,      // Borda no teclado (interrupção), arg = gpio
+    TRACE_KEY_EVENT,     // Tecla publicada pelo debounce, arg = tecla | pressionada << 8
+    TRACE_KEY_HANDLED,   // Evento recebido pela task da interface, arg = tecla | pressionada << 8
+    TRACE_FEEDBACK,      // Padrão de LEDs/buzzer pedido, arg = feedback_pattern_t
+    TRACE_VERIFY_BEGIN,  // Derivação da senha digitada
+    TRACE_VERIFY_END,    // arg = 1 se a senha confere
+    TRACE_FLASH_BEGIN,   // Gravação de registro, arg = tipo
+    TRACE_FLASH_END,     // arg = 1 se gravou
+    TRACE_FRAME_COMMIT,  // Quadro submetido à Display Task
+    TRACE_FLUSH_BEGIN,   // Envio por DMA iniciado
+    TRACE_FLUSH_END,     // Envio por DMA concluído (interrupção)
+    TRACE_ID_COUNT,
+} trace_id_t;
+
+// Registro de 8 bytes, também o formato do dump binário (little-endian)
+typedef struct
+{
+    uint32_t time_us;
+    uint8_t id;
+    uint8_t ring;
+    uint16_t arg;
+} trace_record_t;
+
+#if TRACE_ENABLED
+void trace_init();
+void trace_event(trace_id_t id, uint16_t arg);
+void trace_event_from_isr(trace_id_t id, uint16_t arg);
+void trace_dump_chrome();
+void trace_dump_binary();
+#else
+#define trace_init() ((void)0)
+#define trace_event(id, arg) ((void)0)
+#define trace_event_from_isr(id, arg) ((void)0)
+#endif
+
+#endif
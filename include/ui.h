@@ -0,0 +1,48 @@
+#ifndef UI_H
+#define UI_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+#define UI_TEXT_MAX 16 // Células de um widget de texto: uma linha inteira da fonte 8x8
+
+// Widget retido: guarda o que já está desenhado na tela, e só as células (ou o ícone) que mudaram são
+// redesenhadas. Os campos de posição e tamanho são fixos; o resto é o estado mantido pela camada
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    uint8_t cells;               // Texto: largura em caracteres, preenchida com espaços; imagem e barra: largura em colunas
+    uint8_t pages;               // Imagem: altura em páginas de 8 linhas (y múltiplo de 8); barra: altura em linhas
+    bool valid;                  // Falso até o primeiro desenho depois de ui_show
+    const ssd1306_font_t *font;  // Fonte do texto desenhado
+    int16_t font_y;              // Linha em que o texto desenhado começa
+    const ssd1306_image_t *icon; // Imagem desenhada
+    uint8_t filled;              // Colunas preenchidas da barra desenhada
+    char text[UI_TEXT_MAX + 1];  // Texto desenhado
+} ui_widget_t;
+
+#define UI_TEXT(x_, y_, cells_) {.x = (x_), .y = (y_), .cells = (cells_)}
+#define UI_ICON(x_, y_, width_, pages_) {.x = (x_), .y = (y_), .cells = (width_), .pages = (pages_)}
+#define UI_BAR(x_, y_, width_, height_) {.x = (x_), .y = (y_), .cells = (width_), .pages = (height_)}
+
+// Tela: conjunto de widgets que dividem o display; trocar de tela apaga o display e esquece o que foi desenhado
+typedef struct
+{
+    ui_widget_t *widgets;
+    uint8_t count;
+} ui_screen_t;
+
+#define UI_SCREEN(widgets_) {.widgets = (widgets_), .count = sizeof(widgets_) / sizeof((widgets_)[0])}
+
+void ui_init(ssd1306_t *ssd);
+void ui_begin();
+void ui_end();
+void ui_show(ui_screen_t *screen);
+void ui_text(ui_widget_t *widget, const char *text);
+void ui_textf(ui_widget_t *widget, const char *format, ...);
+void ui_pin(ui_widget_t *widget, const char *pswd, bool visible);
+void ui_icon(ui_widget_t *widget, const ssd1306_image_t *image);
+void ui_bar(ui_widget_t *widget, int value, int max);
+
+#endif
@@ -10,6 +10,12 @@
 #include "matrixkey.h"
 #include "display.h"
 #include "flashpswd.h"
+#include "diagnostics.h"
+#include "trace.h"
+#include "feedback.h"
+#include "power.h"
+#include "ui.h"
+#include "images.h"
 #include "semphr.h"
 
 #define R_LED 13
@@ -17,36 +23,45 @@
 #define G_LED 11
 #define BTN_A 5
 #define BTN_B 6
+#define BTN_A_KEY 'A'
+#define BTN_B_KEY 'B'
 #define BUZZER 21
-#define PASSWORD_SIZE 6
-#define FLASH_TARGET_OFFSET 0x1F000
+
+#define UI_TASK_CORE 0 // Com DUAL_CORE: interface, verificação e estado do cofre junto das interrupções do teclado
 
 #define I2C_PORT i2c1
 #define I2C_SDA 14
 #define I2C_SCL 15
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 64 // 32 para o painel 128x32
 
 TaskHandle_t input_task_handle = NULL;
 TaskHandle_t verify_task_handle = NULL;
 TaskHandle_t vault_task_handle = NULL;
 TaskHandle_t unlocked_task_handle = NULL;
 
-struct render_area frame = {
-    .start_column = 0,
-    .end_column = ssd1306_width - 1,
-    .start_page = 0,
-    .end_page = ssd1306_n_pages - 1,
-};
+static ssd1306_t oled;
 
-uint8_t *ssd;
-volatile bool unlocked = false;
+// Estados do cofre; cada um (exceto LOCKOUT) é conduzido por uma task, ativada pela task_vault na transição
+typedef enum
+{
+    VAULT_NO_PASSWORD, // task_input
+    VAULT_LOCKED,      // task_verify
+    VAULT_UNLOCKED,    // task_unlocked
+    VAULT_LOCKOUT,     // Tentativas esgotadas: permanece travado
+} vault_state_t;
+
+// Eventos enviados à task_vault (bits da notificação)
+#define VAULT_EVT_PSWD_SAVED (1u << 0)
+#define VAULT_EVT_GRANTED (1u << 1)
+#define VAULT_EVT_LOCK (1u << 2)
+#define VAULT_EVT_RESET (1u << 3)
+#define VAULT_EVT_LOCKOUT (1u << 4)
 
 extern const uint8_t ROW_PINS[ROWS_SIZE];
 extern const uint8_t COL_PINS[COLS_SIZE];
 extern const char keyboard_map[ROWS_SIZE][COLS_SIZE];
 
-const uint8_t *flash_pswd = (const uint8_t *)(XIP_BASE + FLASH_TARGET_OFFSET);
-char pswd[PASSWORD_SIZE + 1] = {0};
-
 char *text[] = {
     "ENTER PASSWORD  ",
     "CONFIRM PASSWORD",
@@ -55,270 +70,437 @@ char *text[] = {
     "ACCESS DENIED   ",
     "LOCKED OUT      ",
     "PASSWORD SAVED  ",
-    "DOES NOT MATCH  "};
+    "DOES NOT MATCH  ",
+    "USER ID         "};
 
-void task_input(void *params)
+// Telas da interface: cada widget guarda o que já está desenhado, e só o que muda é redesenhado e enviado
+enum
 {
-    char pswd1[PASSWORD_SIZE + 1] = {0};
-    char pswd2[PASSWORD_SIZE + 1] = {0};
-    int idx1 = 0;
-    int idx2 = 0;
-    bool confirming = false; // false: estamos coletando pswd1, true: pswd2
+    PSWD_TITLE,
+    PSWD_FIELD,
+    PSWD_LENGTH,
+};
+static ui_widget_t pswd_widgets[] = {
+    [PSWD_TITLE] = UI_TEXT(0, 0, 16),
+    [PSWD_FIELD] = UI_TEXT(0, 32, PSWD_MAX_LEN),
+    [PSWD_LENGTH] = UI_BAR(0, 54, 128, 8), // Dígitos digitados, de 0 a PSWD_MAX_LEN
+};
+static ui_screen_t pswd_screen = UI_SCREEN(pswd_widgets);
+
+static ui_widget_t user_widgets[] = {UI_TEXT(0, 0, 16)};
+static ui_screen_t user_screen = UI_SCREEN(user_widgets);
 
-    memset(ssd, 0, ssd1306_buffer_length);
-    ssd1306_draw_string(ssd, 0, 0, text[0]); // ENTER PASSWORD
-    render_on_display(ssd, &frame);
+enum
+{
+    MESSAGE_TOP,
+    MESSAGE_BOTTOM,
+};
+static ui_widget_t message_widgets[] = {
+    [MESSAGE_TOP] = UI_TEXT(5, 16, 15),
+    [MESSAGE_BOTTOM] = UI_TEXT(5, 32, 15),
+};
+static ui_screen_t message_screen = UI_SCREEN(message_widgets);
+
+enum
+{
+    MENU_ICON,
+    MENU_RESET,
+    MENU_LOCK,
+    MENU_USERS,
+};
+static ui_widget_t menu_widgets[] = {
+    [MENU_ICON] = UI_ICON(120, 0, 8, 1),
+    [MENU_RESET] = UI_TEXT(8, 8, 12),
+    [MENU_LOCK] = UI_TEXT(8, 24, 11),
+    [MENU_USERS] = UI_TEXT(8, 40, 15),
+};
+static ui_screen_t menu_screen = UI_SCREEN(menu_widgets);
+
+enum
+{
+    NOTICE_ICON,
+    NOTICE_TEXT,
+};
+static ui_widget_t notice_widgets[] = {
+    [NOTICE_ICON] = UI_ICON(48, 0, 32, 4),
+    [NOTICE_TEXT] = UI_TEXT(24, 40, 10),
+};
+static ui_screen_t notice_screen = UI_SCREEN(notice_widgets);
+
+// Mensagem de uma ou duas linhas (a de cima pode ser NULL)
+static void show_message(const char *top, const char *bottom)
+{
+    ui_begin();
+    ui_show(&message_screen);
+    ui_text(&message_widgets[MESSAGE_TOP], top ? top : "");
+    ui_text(&message_widgets[MESSAGE_BOTTOM], bottom);
+    ui_end();
+}
+
+// Bloqueia até o próximo evento do teclado; retorna a tecla pressionada (dígito, '*' ou '#')
+// ou '\0' quando só o BTN_B mudou
+static char wait_key(bool *show_pswd)
+{
+    keypad_event_t event;
 
     while (true)
     {
-        char digit = read_digit(ROW_PINS, COL_PINS);
-        if (!confirming)
+        if (!keypad_get_event(&event, portMAX_DELAY))
+            continue;
+
+        trace_event(TRACE_KEY_HANDLED, (uint8_t)event.key | event.pressed << 8);
+
+        if (event.pressed && power_activity())
+            continue; // A tecla só acordou o display
+
+        if (event.key == BTN_B_KEY)
         {
-            if (digit != '\0' && idx < PASSWORD_SIZE && digit != '*' && digit != '#')
-            {
-                pswd1[idx1++] = digit;
-                pswd1[idx1] = '\0';
-                click_feedback(R_LED, BUZZER, 100);
-            }
+            *show_pswd = event.pressed;
+            return '\0';
+        }
 
-            bool show_pswd = (gpio_get(BTN_B) == 0);
-            draw_pswd(ssd, ssd1306_buffer_length, &frame, pswd1, idx1, 5, 32, show_pswd);
+        if (event.pressed && ((event.key >= '0' && event.key <= '9') || event.key == '*' || event.key == '#'))
+            return event.key;
+    }
+}
 
-            if (idx1 == PASSWORD_SIZE)
-            {
-                confirming = true;
-                idx2 = 0;
-                memset(ssd, 0, ssd1306_buffer_length);
-                ssd1306_draw_string(ssd, 0, 0, text[1]); // CONFIRM PASSWORD
-                render_on_display(ssd, &frame);
-                vTaskDelay(pdMS_TO_TICKS(500));
-            }
+// Mantém a mensagem na tela por UI_MESSAGE_MS; uma tecla pressionada encerra antes. Essa tecla é consumida:
+// só dispensa a mensagem, sem valer na tela seguinte (no menu, BTN A apagaria todas as senhas)
+static void hold_message()
+{
+    keypad_event_t event;
+
+    if (keypad_wait_press(pdMS_TO_TICKS(UI_MESSAGE_MS)) && keypad_get_event(&event, 0))
+    {
+        trace_event(TRACE_KEY_HANDLED, (uint8_t)event.key | event.pressed << 8);
+        power_activity();
+    }
+}
+
+static void vault_post(uint32_t event)
+{
+    xTaskNotify(vault_task_handle, event, eSetBits);
+}
+
+// Bloqueia a task até a task_vault entrar no estado que ela conduz
+static void wait_activation()
+{
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+// Coleta uma senha de PSWD_MIN_LEN a PSWD_MAX_LEN dígitos em pswd (PSWD_MAX_LEN + 1 bytes):
+// '*' apaga o último dígito e '#' confirma. Retorna o tamanho da senha
+static int read_pswd(char *title, char *pswd)
+{
+    int len = 0;
+    bool show_pswd = false;
+
+    memset(pswd, 0, PSWD_MAX_LEN + 1);
+
+    ui_begin();
+    ui_show(&pswd_screen);
+    ui_text(&pswd_widgets[PSWD_TITLE], title);
+    ui_pin(&pswd_widgets[PSWD_FIELD], pswd, show_pswd);
+    ui_bar(&pswd_widgets[PSWD_LENGTH], len, PSWD_MAX_LEN);
+    ui_end();
+
+    while (true)
+    {
+        char key = wait_key(&show_pswd);
+
+        if (key == '#' && len >= PSWD_MIN_LEN)
+            return len;
+
+        if (key >= '0' && key <= '9' && len < PSWD_MAX_LEN)
+        {
+            pswd[len++] = key;
+            feedback_play(FEEDBACK_CLICK);
         }
-        else
+        else if (key == '*' && len > 0)
         {
-            if (digit != '\0' && idx < PASSWORD_SIZE && digit != '*' && digit != '#')
-            {
-                pswd2[idx2++] = digit;
-                pswd2[idx2] = '\0';
-                click_feedback(R_LED, BUZZER, 100);
-            }
+            pswd[--len] = '\0';
+            feedback_play(FEEDBACK_CLICK);
+        }
 
-            bool show_pswd = (gpio_get(BTN_B) == 0);
-            draw_pswd(ssd, ssd1306_buffer_length, &frame, pswd2, idx2, 5, 32, show_pswd);
+        ui_begin();
+        ui_pin(&pswd_widgets[PSWD_FIELD], pswd, show_pswd);
+        ui_bar(&pswd_widgets[PSWD_LENGTH], len, PSWD_MAX_LEN);
+        ui_end();
+    }
+}
 
-            if (idx2 == PASSWORD_SIZE)
-            {
-                if (strncmp(pswd1, pswd2, PASSWORD_SIZE) == 0)
-                {
-                    memset(ssd, 0, ssd1306_buffer_length);
-                    ssd1306_draw_string(ssd, 5, 32, text[6]); // PASSWORD SAVED
-                    render_on_display(ssd, &frame);
+// Pergunta o usuário quando há mais de um cadastrado; retorna o índice na tabela de credenciais
+static int read_user()
+{
+    bool show_pswd = false;
 
-                    gpio_put(G_LED, 1);
-                    vTaskDelay(pdMS_TO_TICKS(1500));
-                    gpio_put(G_LED, 0);
+    if (flash_user_count() <= 1)
+    {
+        for (int user = 0; user < PSWD_USER_SLOTS; user++)
+            if (flash_pswd_exists(user))
+                return user;
+    }
 
-                    flash_write_pswd(pswd1, PASSWORD_SIZE);
-                    // vTaskResume(verify_task_handle);
-                    vTaskSuspend(NULL);
-                }
-                else
-                {
-                    memset(ssd, 0, ssd1306_buffer_length);
-                    ssd1306_draw_string(ssd, 5, 32, text[7]); // DOES NOT MATCH
-                    render_on_display(ssd, &frame);
-                    gpio_put(R_LED, 1);
-                    vTaskDelay(pdMS_TO_TICKS(1500));
-                    gpio_put(R_LED, 0);
-
-                    memset(pswd1, 0, sizeof(pswd1));
-                    memset(pswd2, 0, sizeof(pswd2));
-                    idx1 = 0;
-                    idx2 = 0;
-                    confirming = false;
-
-                    memset(ssd, 0, ssd1306_buffer_length);
-                    ssd1306_draw_string(ssd, 0, 0, text[0]); // ENTER PASSWORD
-                    render_on_display(ssd, &frame);
-                }
-            }
+    ui_begin();
+    ui_show(&user_screen);
+    ui_text(&user_widgets[0], text[8]); // USER ID
+    ui_end();
+
+    while (true)
+    {
+        char key = wait_key(&show_pswd);
+
+        if (key >= '1' && key < '1' + PSWD_USER_SLOTS)
+        {
+            feedback_play(FEEDBACK_CLICK);
+            return key - '1';
+        }
+    }
+}
+
+// Cadastra (ou substitui) a senha do usuário: digitação e confirmação, repetindo até as duas coincidirem
+static void enroll_user(int user)
+{
+    char pswd1[PSWD_MAX_LEN + 1];
+    char pswd2[PSWD_MAX_LEN + 1];
+    bool saved = false;
+
+    while (!saved)
+    {
+        int len1 = read_pswd(text[0], pswd1); // ENTER PASSWORD
+        int len2 = read_pswd(text[1], pswd2); // CONFIRM PASSWORD
+
+        if (len1 == len2 && strncmp(pswd1, pswd2, PSWD_MAX_LEN) == 0)
+        {
+            show_message(NULL, text[6]); // PASSWORD SAVED
+
+            feedback_play(FEEDBACK_SUCCESS);
+            hold_message();
+
+            flash_write_pswd(user, pswd1, len1);
+            saved = true;
+        }
+        else
+        {
+            show_message(NULL, text[7]); // DOES NOT MATCH
+            display_animate(DISPLAY_ANIM_SHAKE);
+
+            feedback_play(FEEDBACK_DENIED);
+            hold_message();
         }
+    }
+
+    memset(pswd1, 0, sizeof(pswd1));
+    memset(pswd2, 0, sizeof(pswd2));
+}
+
+void task_input(void *params)
+{
+    while (true)
+    {
+        wait_activation();
+
+        // Sem nenhuma senha, o primeiro cadastro é sempre o do usuário 1
+        enroll_user(0);
 
-        vTaskDelay(pdMS_TO_TICKS(50)); 
+        vault_post(VAULT_EVT_PSWD_SAVED);
     }
 }
 
 void task_verify(void *params)
 {
-    int idx = 0;
     int try_count = 4;
-    char attempt[PASSWORD_SIZE + 1] = {0};
+    char attempt[PSWD_MAX_LEN + 1] = {0};
 
     while (true)
     {
-        idx = 0;
-        try_count = 4;
-        memset(attempt, 0, sizeof(attempt));
-        unlocked = false;
+        wait_activation();
 
-        memset(ssd, 0, ssd1306_buffer_length);
-        ssd1306_draw_string(ssd, 0, 0, text[2]); // TRY PASSWORD
-        render_on_display(ssd, &frame);
+        try_count = 4;
+        bool granted = false;
 
-        while (!unlocked)
+        while (!granted && try_count > 0)
         {
-            char digit = read_digit(ROW_PINS, COL_PINS);
+            int user = read_user();
+            read_pswd(text[2], attempt); // TRY PASSWORD
 
-            if (digit != '\0' && idx < PASSWORD_SIZE && digit != '*' && digit != '#')
-            {
-                attempt[idx++] = digit;
-                attempt[idx] = '\0';
-                click_feedback(R_LED, BUZZER, 100);
+            bool match = pswd_matches(user, attempt);
+            memset(attempt, 0, sizeof(attempt));
 
-                memset(ssd, 0, ssd1306_buffer_length);
-                ssd1306_draw_string(ssd, 0, 0, text[2]); // TRY PASSWORD
-                render_on_display(ssd, &frame);
-            }
+            if (match)
+            {
+                show_message(NULL, text[3]); // ACCESS GRANTED
+                display_animate(DISPLAY_ANIM_FLASH);
 
-            bool show_pswd = (gpio_get(BTN_B) == 0);
-            draw_pswd(ssd, ssd1306_buffer_length, &frame, attempt, idx, 5, 32, show_pswd);
+                feedback_play(FEEDBACK_SUCCESS);
+                hold_message();
 
-            if (idx == PASSWORD_SIZE)
+                granted = true;
+            }
+            else
             {
-                if (pswd_matches(attempt, flash_pswd))
-                {
-                    memset(ssd, 0, ssd1306_buffer_length);
-                    ssd1306_draw_string(ssd, 5, 32, text[3]); // ACCESS GRANTED
-                    render_on_display(ssd, &frame);
+                try_count--;
 
-                    gpio_put(G_LED, 1);
-                    vTaskDelay(pdMS_TO_TICKS(1500));
-                    gpio_put(G_LED, 0);
-
-                    unlocked = true;
+                if (try_count <= 0)
+                {
+                    // Ninguém mais lê o teclado: sem power_hold, o display apagaria por inatividade
+                    power_hold();
+                    show_message(NULL, text[5]); // LOCKED OUT
+                    display_animate(DISPLAY_ANIM_MARQUEE); // Fica rolando pelo controlador, sem tráfego no i2c
+                    feedback_play(FEEDBACK_LOCKOUT);
                 }
                 else
                 {
-                    try_count--;
-                    memset(ssd, 0, ssd1306_buffer_length);
-
-                    if (try_count <= 0)
-                    {
-                        ssd1306_draw_string(ssd, 5, 32, text[5]); // LOCKED OUT
-                        render_on_display(ssd, &frame);
-                        gpio_put(R_LED, 1);
-                        vTaskSuspend(NULL);
-                    }
-                    else
-                    {
-                        ssd1306_draw_string(ssd, 5, 16, text[4]); // ACCESS DENIED
-                        char msg[32];
-                        snprintf(msg, sizeof(msg), "TRIES LEFT: %d", try_count);
-                        ssd1306_draw_string(ssd, 5, 32, msg);
-                        render_on_display(ssd, &frame);
-
-                        gpio_put(R_LED, 1);
-                        vTaskDelay(pdMS_TO_TICKS(1500));
-                        gpio_put(R_LED, 0);
-
-                        // Reseta para a próxima tentativa
-                        idx = 0;
-                        memset(attempt, 0, sizeof(attempt));
-
-                        // Limpa a tela para a próxima tentativa
-                        /* memset(ssd, 0, ssd1306_buffer_length);
-                        ssd1306_draw_string(ssd, 0, 0, text[2]); // TRY PASSWORD
-                        render_on_display(ssd, &frame); */
-                    }
+                    ui_begin();
+                    ui_show(&message_screen);
+                    ui_text(&message_widgets[MESSAGE_TOP], text[4]); // ACCESS DENIED
+                    ui_textf(&message_widgets[MESSAGE_BOTTOM], "TRIES LEFT: %d", try_count);
+                    ui_end();
+                    display_animate(DISPLAY_ANIM_SHAKE);
+
+                    feedback_play(FEEDBACK_DENIED);
+                    hold_message();
                 }
             }
         }
-        vTaskSuspend(NULL);
+
+        vault_post(granted ? VAULT_EVT_GRANTED : VAULT_EVT_LOCKOUT);
     }
 }
 
+static void draw_unlocked_menu()
+{
+    ui_begin();
+    ui_show(&menu_screen);
+    ui_icon(&menu_widgets[MENU_ICON], &image_lock_open_8);
+    ui_text(&menu_widgets[MENU_RESET], "BTN A  RESET");
+    ui_text(&menu_widgets[MENU_LOCK], "BTN B  LOCK");
+    ui_textf(&menu_widgets[MENU_USERS], "1 TO %d SET USER", PSWD_USER_SLOTS);
+    ui_end();
+}
+
 void task_unlocked(void *params)
 {
     while (true)
     {
+        wait_activation();
+
         bool running = true;
+
+        // Espera BTN_B (bloquear), BTN_A (resetar) ou o número de um usuário para cadastrar sua senha
+        draw_unlocked_menu();
+        display_animate(DISPLAY_ANIM_ROLL_IN);
+
         while (running)
         {
-            // Espera BTN_B (bloquear) ou BTN_A (resetar)
-            memset(ssd, 0, ssd1306_buffer_length);
-            ssd1306_draw_string(ssd, 8, 8, "BTN A  RESET");
-            ssd1306_draw_string(ssd, 8, 24, "BTN B  LOCK");
-            render_on_display(ssd, &frame);
+            keypad_event_t event;
+            if (!keypad_get_event(&event, portMAX_DELAY) || !event.pressed || power_activity())
+                continue;
+
+            if (event.key >= '1' && event.key < '1' + PSWD_USER_SLOTS)
+            {
+                feedback_play(FEEDBACK_CLICK);
+                enroll_user(event.key - '1');
+                draw_unlocked_menu();
+            }
 
-            if (gpio_get(BTN_B) == 0)
+            if (event.key == BTN_B_KEY)
             {
-                memset(ssd, 0, ssd1306_buffer_length);
-                ssd1306_draw_string(ssd, 32, 32, "LOCKED");
-                render_on_display(ssd, &frame);
+                ui_begin();
+                ui_show(&notice_screen);
+                ui_icon(&notice_widgets[NOTICE_ICON], &image_lock_open_32);
+                ui_text(&notice_widgets[NOTICE_TEXT], "  LOCKED");
+                ui_end();
+
+                // O cadeado fecha em seguida: o segundo quadro é só o delta da alça
+                vTaskDelay(pdMS_TO_TICKS(UI_CLICK_MS * 2));
+                ui_begin();
+                ui_icon(&notice_widgets[NOTICE_ICON], &image_lock_closed_32);
+                ui_end();
 
-                gpio_put(R_LED, 1);
-                vTaskDelay(pdMS_TO_TICKS(1500));
-                gpio_put(R_LED, 0);
+                feedback_play(FEEDBACK_LOCKED);
+                hold_message();
 
                 // Bloquear novamente
-                unlocked = false;
+                vault_post(VAULT_EVT_LOCK);
                 running = false;
             }
 
-            if (gpio_get(BTN_A) == 0)
+            if (event.key == BTN_A_KEY)
             {
-                // Resetar senha
-                flash_erase_pswd(PASSWORD_SIZE);
-                memset(ssd, 0, ssd1306_buffer_length);
-                ssd1306_draw_string(ssd, 24, 24, "RESET DONE");
-                render_on_display(ssd, &frame);
-                gpio_put(B_LED, 1);
-                vTaskDelay(pdMS_TO_TICKS(1500));
-                gpio_put(B_LED, 0);
-
-                unlocked = false;
-                running = false; // Sair do loop e suspender a task
+                // Resetar as senhas de todos os usuários
+                flash_erase_all();
+                ui_begin();
+                ui_show(&notice_screen);
+                ui_icon(&notice_widgets[NOTICE_ICON], NULL);
+                ui_text(&notice_widgets[NOTICE_TEXT], "RESET DONE");
+                ui_end();
+                feedback_play(FEEDBACK_RESET);
+                hold_message();
+
+                vault_post(VAULT_EVT_RESET);
+                running = false; // Sair do loop e esperar a próxima ativação
             }
-
-            vTaskDelay(pdMS_TO_TICKS(100));
         }
-        vTaskSuspend(NULL);
+    }
+}
+
+// Calcula o próximo estado a partir dos eventos recebidos; eventos que não valem no estado atual são ignorados
+static vault_state_t vault_next_state(vault_state_t state, uint32_t events)
+{
+    switch (state)
+    {
+    case VAULT_NO_PASSWORD:
+        return (events & VAULT_EVT_PSWD_SAVED) ? VAULT_LOCKED : state;
+    case VAULT_LOCKED:
+        if (events & VAULT_EVT_GRANTED)
+            return VAULT_UNLOCKED;
+        return (events & VAULT_EVT_LOCKOUT) ? VAULT_LOCKOUT : state;
+    case VAULT_UNLOCKED:
+        if (events & VAULT_EVT_RESET)
+            return VAULT_NO_PASSWORD;
+        return (events & VAULT_EVT_LOCK) ? VAULT_LOCKED : state;
+    default:
+        return state;
+    }
+}
+
+// Ativa a task que conduz o novo estado
+static void vault_enter(vault_state_t state)
+{
+    switch (state)
+    {
+    case VAULT_NO_PASSWORD:
+        xTaskNotifyGive(input_task_handle);
+        break;
+    case VAULT_LOCKED:
+        xTaskNotifyGive(verify_task_handle);
+        break;
+    case VAULT_UNLOCKED:
+        xTaskNotifyGive(unlocked_task_handle);
+        break;
+    case VAULT_LOCKOUT:
+        break;
     }
 }
 
 void task_vault(void *params)
 {
-    vTaskSuspend(input_task_handle);
-    vTaskSuspend(verify_task_handle);
-    vTaskSuspend(unlocked_task_handle);
+    // A flash só é consultada na partida; depois disso o estado muda apenas pelos eventos das tasks
+    vault_state_t state = flash_user_count() > 0 ? VAULT_LOCKED : VAULT_NO_PASSWORD;
+    vault_enter(state);
 
     while (true)
     {
-        bool pswd_exists = flash_pswd_exists(flash_pswd);
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
 
-        if (unlocked)
+        vault_state_t next = vault_next_state(state, events);
+        if (next != state)
         {
-            // Estado: Desbloqueado. Gerenciado pela task_unlocked.
-            vTaskSuspend(input_task_handle);
-            vTaskSuspend(verify_task_handle);
-            vTaskResume(unlocked_task_handle);
+            state = next;
+            vault_enter(state);
         }
-        else if (pswd_exists)
-        {
-            // Estado: Bloqueado, com senha. Gerenciado pela task_verify.
-            vTaskSuspend(input_task_handle);
-            vTaskSuspend(unlocked_task_handle);
-            vTaskResume(verify_task_handle);
-        }
-        else // !unlocked && !pswd_exists
-        {
-            // Estado: Bloqueado, sem senha. Gerenciado pela task_input.
-            vTaskSuspend(verify_task_handle);
-            vTaskSuspend(unlocked_task_handle);
-            vTaskResume(input_task_handle);
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(200));
     }
 }
 
@@ -327,18 +509,13 @@ int main()
     stdio_init_all();
 
     init_matrix_keypad();
+    flash_pswd_init();
+#ifdef PSWD_BENCHMARK
+    pswd_benchmark(PSWD_BENCHMARK);
+#endif
 
-    gpio_init(R_LED);
-    gpio_set_dir(R_LED, GPIO_OUT);
-    gpio_put(R_LED, 0);
-
-    gpio_init(B_LED);
-    gpio_set_dir(B_LED, GPIO_OUT);
-    gpio_put(B_LED, 0);
-
-    gpio_init(G_LED);
-    gpio_set_dir(G_LED, GPIO_OUT);
-    gpio_put(G_LED, 0);
+    // LEDs e buzzer (PWM) tocados pela Timer Task, sem bloquear quem pede o feedback
+    feedback_init(R_LED, G_LED, B_LED, BUZZER);
 
     gpio_init(BTN_A);
     gpio_set_dir(BTN_A, GPIO_IN);
@@ -346,31 +523,29 @@ int main()
     gpio_init(BTN_B);
     gpio_set_dir(BTN_B, GPIO_IN);
     gpio_pull_up(BTN_B);
-
-    gpio_init(BUZZER);
-    gpio_set_dir(BUZZER, GPIO_OUT);
-    gpio_put(BUZZER, 0);
-
-    i2c_init(I2C_PORT, ssd1306_i2c_clock * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    ssd1306_init();
-
-    calculate_render_area_buffer_length(&frame);
-    ssd = (uint8_t *)malloc(ssd1306_buffer_length);
-    if (ssd == NULL)
-    {
-        printf("Failed to allocate memory for display buffer\n");
-        gpio_put(R_LED, 1);
-        sleep_ms(2000);
-        return -1;
-    }
-    memset(ssd, 0, ssd1306_buffer_length);
-    render_on_display(ssd, &frame);
-
-    gpio_put(G_LED, 1);
-    sleep_ms(1500);
-    gpio_put(G_LED, 0);
+    keypad_add_button(BTN_A, BTN_A_KEY);
+    keypad_add_button(BTN_B, BTN_B_KEY);
+
+    // O clock do barramento é sondado a partir de 1 MHz e cai sozinho se o painel começar a errar
+    if (!ssd1306_init(&oled, OLED_WIDTH, OLED_HEIGHT, false, ssd1306_i2c_address,
+                      i2c_bus_init(I2C_PORT, I2C_SDA, I2C_SCL, ssd1306_i2c_clock)))
+        printf("display: no answer on i2c\n");
+
+    ssd1306_clear(&oled);
+    ssd1306_flush(&oled);
+
+    // A partir daqui o display pertence à Display Task; as tasks desenham pelos widgets de ui.h, entre ui_begin/ui_end
+    ui_init(display_init(&oled));
+    flash_service_init();
+#ifdef DIAG_REPORT_MS
+    diag_init(DIAG_REPORT_MS);
+#endif
+    trace_init();
+#if LOW_POWER
+    power_init();
+#endif
+
+    feedback_play(FEEDBACK_BOOT);
 
     xTaskCreate(task_input, "Input Task", 2048, NULL, 1, &input_task_handle);
     xTaskCreate(task_verify, "Verify Task", 2048, NULL, 1, &verify_task_handle);
@@ -379,6 +554,12 @@ int main()
     // Task Gerente maior prioridade
     xTaskCreate(task_vault, "Vault Task", 2048, NULL, 2, &vault_task_handle);
 
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    TaskHandle_t ui_tasks[] = {input_task_handle, verify_task_handle, unlocked_task_handle, vault_task_handle};
+    for (int i = 0; i < count_of(ui_tasks); i++)
+        vTaskCoreAffinitySet(ui_tasks[i], 1u << UI_TASK_CORE);
+#endif
+
     vTaskStartScheduler();
 
     while (true)
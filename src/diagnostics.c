@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include "diagnostics.h"
+#include "power.h"
+#include "i2c_bus.h"
+
+// Tempo de execução de cada task no relatório anterior, para calcular a carga só do último intervalo
+typedef struct
+{
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE run_time;
+} diag_sample_t;
+
+static diag_sample_t previous[DIAG_MAX_TASKS];
+static int previous_count = 0;
+static configRUN_TIME_COUNTER_TYPE previous_total = 0;
+static uint32_t previous_bus_bytes[I2C_BUS_COUNT];
+static uint64_t previous_report_us = 0;
+#if LOW_POWER
+static uint64_t previous_asleep_us = 0;
+static uint64_t previous_uptime_us = 0;
+#endif
+
+static configRUN_TIME_COUNTER_TYPE previous_run_time(TaskHandle_t handle)
+{
+    for (int i = 0; i < previous_count; i++)
+        if (previous[i].handle == handle)
+            return previous[i].run_time;
+
+    return 0;
+}
+
+static char state_letter(eTaskState state)
+{
+    switch (state)
+    {
+    case eRunning:
+        return 'X';
+    case eReady:
+        return 'R';
+    case eBlocked:
+        return 'B';
+    case eSuspended:
+        return 'S';
+    default:
+        return 'D';
+    }
+}
+
+// Imprime no stdio a carga de CPU de cada task desde o último relatório, a menor folga de pilha já
+// registrada (em palavras), o heap livre atual e mínimo, o tráfego de cada barramento i2c e, com LOW_POWER,
+// o tempo dormindo
+void diag_report()
+{
+    static TaskStatus_t status[DIAG_MAX_TASKS];
+    configRUN_TIME_COUNTER_TYPE total;
+
+    UBaseType_t count = uxTaskGetSystemState(status, DIAG_MAX_TASKS, &total);
+    configRUN_TIME_COUNTER_TYPE interval = total - previous_total;
+
+    printf("diag: uptime %llu ms, heap free %u B (min %u B), %u tasks\n",
+           (unsigned long long)(time_us_64() / 1000), (unsigned)xPortGetFreeHeapSize(),
+           (unsigned)xPortGetMinimumEverFreeHeapSize(), (unsigned)uxTaskGetNumberOfTasks());
+    printf("diag: %-16s %s %4s %6s %10s\n", "task", "st", "prio", "cpu%", "stack_min");
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        TaskStatus_t *task = &status[i];
+        configRUN_TIME_COUNTER_TYPE used = task->ulRunTimeCounter - previous_run_time(task->xHandle);
+
+        printf("diag: %-16s %c  %4u %6.1f %10u\n", task->pcTaskName, state_letter(task->eCurrentState),
+               (unsigned)task->uxCurrentPriority, interval ? 100.0 * used / interval : 0.0,
+               (unsigned)task->usStackHighWaterMark);
+    }
+
+    previous_count = 0;
+    for (UBaseType_t i = 0; i < count; i++)
+        previous[previous_count++] = (diag_sample_t){status[i].xHandle, status[i].ulRunTimeCounter};
+    previous_total = total;
+
+    // Barramentos i2c: clock atual, taxa desde o último relatório e contadores desde a partida
+    uint64_t now_us = time_us_64();
+    for (uint i = 0; i < I2C_BUS_COUNT; i++)
+    {
+        i2c_bus_t *bus = i2c_bus_get(i);
+        if (bus == NULL)
+            continue;
+
+        i2c_bus_stats_t stats = bus->stats;
+        printf("diag: i2c%u %u kHz, %.0f B/s, %lu tx, %lu B, %lu errors (%lu timeouts), %lu recoveries, %lu fallbacks\n",
+               i, bus->khz,
+               now_us > previous_report_us ? 1e6 * (stats.bytes - previous_bus_bytes[i]) / (now_us - previous_report_us) : 0.0,
+               (unsigned long)stats.transactions, (unsigned long)stats.bytes, (unsigned long)stats.errors,
+               (unsigned long)stats.timeouts, (unsigned long)stats.recoveries, (unsigned long)stats.fallbacks);
+        previous_bus_bytes[i] = stats.bytes;
+    }
+    previous_report_us = now_us;
+
+#if LOW_POWER
+    // Medição do baixo consumo: fração do intervalo e do tempo desde a partida com o núcleo em WFI
+    uint64_t asleep_us, uptime_us;
+    power_sleep_stats(&asleep_us, &uptime_us);
+
+    uint64_t interval_us = uptime_us - previous_uptime_us;
+    printf("diag: asleep %.1f%% (awake %llu ms of %llu ms), %.1f%% since boot\n",
+           interval_us ? 100.0 * (asleep_us - previous_asleep_us) / interval_us : 0.0,
+           (unsigned long long)((interval_us - (asleep_us - previous_asleep_us)) / 1000),
+           (unsigned long long)(interval_us / 1000), uptime_us ? 100.0 * asleep_us / uptime_us : 0.0);
+
+    previous_asleep_us = asleep_us;
+    previous_uptime_us = uptime_us;
+#endif
+}
+
+static void task_diag(void *params)
+{
+    uint32_t period_ms = (uint32_t)(uintptr_t)params;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(period_ms));
+        diag_report();
+    }
+}
+
+// Cria a task que imprime o relatório a cada period_ms
+void diag_init(uint32_t period_ms)
+{
+    xTaskCreate(task_diag, "Diag Task", DIAG_TASK_STACK, (void *)(uintptr_t)period_ms, DIAG_TASK_PRIORITY, NULL);
+}
+
+// Chamado pelo kernel na troca de contexto quando a pilha de uma task passou do limite (configCHECK_FOR_STACK_OVERFLOW)
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name)
+{
+    printf("diag: stack overflow in %s\n", name);
+    panic("stack overflow in %s", name);
+}
@@ -1,16 +1,385 @@
 #include "display.h"
+#include "trace.h"
 
-void draw_pswd(uint8_t *ssd, size_t ssd_len, struct render_area *area, char *pswd, uint8_t pswd_len, int16_t x, int16_t y, bool visible)
+#define DISPLAY_EVT_FRAME (1u << 0)
+#define DISPLAY_EVT_DMA_DONE (1u << 1)
+#define DISPLAY_EVT_POWER (1u << 2)
+#define DISPLAY_EVT_ANIMATE (1u << 3)
+#define DISPLAY_EVT_CURSOR (1u << 4)
+
+// Operações de um passo de animação: só comandos ao SSD1306, sem reenviar a tela
+typedef enum
+{
+    DISPLAY_OP_CONTRAST,   // value: fração (de 255) do brilho atual
+    DISPLAY_OP_START_LINE, // value: linha da GDDRAM no topo do painel
+    DISPLAY_OP_INVERT,     // value: 1 inverte, 0 volta ao normal
+    DISPLAY_OP_SCROLL,     // value: página rolada para a esquerda até o próximo quadro
+} display_op_t;
+
+// Um passo aplica a operação e espera duration_ms até o próximo; a animação termina no último passo
+typedef struct
+{
+    uint8_t op;
+    uint8_t value;
+    uint16_t duration_ms;
+} display_step_t;
+
+static const display_step_t fade_in_steps[] = {
+    {DISPLAY_OP_CONTRAST, 0, 30},
+    {DISPLAY_OP_CONTRAST, 16, 30},
+    {DISPLAY_OP_CONTRAST, 48, 30},
+    {DISPLAY_OP_CONTRAST, 96, 30},
+    {DISPLAY_OP_CONTRAST, 160, 30},
+    {DISPLAY_OP_CONTRAST, 255, 0},
+};
+
+static const display_step_t roll_in_steps[] = {
+    {DISPLAY_OP_START_LINE, 48, 20},
+    {DISPLAY_OP_START_LINE, 40, 20},
+    {DISPLAY_OP_START_LINE, 32, 20},
+    {DISPLAY_OP_START_LINE, 24, 20},
+    {DISPLAY_OP_START_LINE, 16, 20},
+    {DISPLAY_OP_START_LINE, 8, 20},
+    {DISPLAY_OP_START_LINE, 0, 0},
+};
+
+static const display_step_t shake_steps[] = {
+    {DISPLAY_OP_START_LINE, 4, 40},
+    {DISPLAY_OP_START_LINE, (uint8_t)-4, 40},
+    {DISPLAY_OP_START_LINE, 4, 40},
+    {DISPLAY_OP_START_LINE, (uint8_t)-4, 40},
+    {DISPLAY_OP_START_LINE, 0, 0},
+};
+
+static const display_step_t flash_steps[] = {
+    {DISPLAY_OP_INVERT, 1, 120},
+    {DISPLAY_OP_INVERT, 0, 120},
+    {DISPLAY_OP_INVERT, 1, 120},
+    {DISPLAY_OP_INVERT, 0, 0},
+};
+
+static const display_step_t marquee_steps[] = {
+    {DISPLAY_OP_SCROLL, DISPLAY_MARQUEE_PAGE, 0},
+};
+
+static const struct
+{
+    const display_step_t *steps;
+    int count;
+} animations[DISPLAY_ANIM_COUNT] = {
+    [DISPLAY_ANIM_FADE_IN] = {fade_in_steps, count_of(fade_in_steps)},
+    [DISPLAY_ANIM_ROLL_IN] = {roll_in_steps, count_of(roll_in_steps)},
+    [DISPLAY_ANIM_SHAKE] = {shake_steps, count_of(shake_steps)},
+    [DISPLAY_ANIM_FLASH] = {flash_steps, count_of(flash_steps)},
+    [DISPLAY_ANIM_MARQUEE] = {marquee_steps, count_of(marquee_steps)},
+};
+
+// Painel cujo framebuffer é a tela em que as tasks desenham; protegida por canvas_mutex entre display_begin e
+// display_commit
+static ssd1306_t *panel = NULL;
+static SemaphoreHandle_t canvas_mutex = NULL;
+static TaskHandle_t display_task_handle = NULL;
+static volatile display_power_t power_request = DISPLAY_POWER_ON;
+static volatile display_anim_t anim_request = DISPLAY_ANIM_FADE_IN;
+
+// Cursor piscante (largura 0: sem cursor); também protegido por canvas_mutex
+static struct
+{
+    int16_t x;
+    int16_t y;
+    uint8_t width;
+    uint8_t height;
+    bool on;
+} cursor;
+
+static void display_dma_done(ssd1306_t *ssd)
+{
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(display_task_handle, DISPLAY_EVT_DMA_DONE, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static uint8_t power_contrast(display_power_t power)
+{
+    return power == DISPLAY_POWER_DIM ? DISPLAY_CONTRAST_DIM : DISPLAY_CONTRAST_ON;
+}
+
+// Os comandos vão pela escrita bloqueante do SDK, que desliga e religa o bloco i2c: o que um envio por DMA
+// ainda tem no FIFO precisa terminar de sair antes, ou seria cortado
+static void display_wait_bus()
+{
+    i2c_bus_wait_idle(panel->bus, i2c_bus_timeout_us(panel->bus, I2C_BUS_FIFO_DEPTH));
+}
+
+static void display_apply_power(display_power_t power)
+{
+    display_wait_bus();
+    ssd1306_contrast(panel, power_contrast(power));
+    ssd1306_power(panel, power != DISPLAY_POWER_OFF);
+}
+
+static void display_apply_step(const display_step_t *step, display_power_t power)
+{
+    display_wait_bus();
+    switch (step->op)
+    {
+    case DISPLAY_OP_CONTRAST:
+        ssd1306_contrast(panel, power_contrast(power) * step->value / 255);
+        break;
+    case DISPLAY_OP_START_LINE:
+        ssd1306_start_line(panel, step->value);
+        break;
+    case DISPLAY_OP_INVERT:
+        ssd1306_invert(panel, step->value);
+        break;
+    case DISPLAY_OP_SCROLL:
+        ssd1306_scroll_pages(panel, true, step->value, step->value, ssd1306_scroll_frames_2);
+        break;
+    }
+}
+
+// Desfaz os efeitos de uma animação interrompida no meio
+static void display_reset_effects(display_power_t power)
+{
+    display_wait_bus();
+    ssd1306_start_line(panel, 0);
+    ssd1306_invert(panel, false);
+    ssd1306_contrast(panel, power_contrast(power));
+}
+
+static void draw_cursor(bool on)
+{
+    ssd1306_fill_rect(panel, cursor.x, cursor.y, cursor.width, cursor.height, on ? SSD1306_COLOR_WHITE : SSD1306_COLOR_BLACK);
+    cursor.on = on;
+}
+
+// Ticks até o instante due (0 se já passou)
+static TickType_t ticks_until(TickType_t due, TickType_t now)
 {
-    char buffer[pswd_len + 1];
-    int len = strlen(pswd);
+    return (int32_t)(due - now) > 0 ? due - now : 0;
+}
 
-    for (int i = 0; i < len; i++)
+// Única dona do SSD1306 após a inicialização: copia a tela submetida para a sequência do DMA
+// (liberando a tela logo em seguida) e só prepara o próximo envio quando o anterior termina. Entre os
+// envios aplica os passos das animações (só comandos) e pisca o cursor (um envio parcial de poucos bytes).
+// Um envio que falha ou passa do tempo (barramento preso) é abandonado e a tela inteira vai de novo
+static void task_display(void *params)
+{
+    bool busy = false;
+    bool draining = false; // O DMA terminou, mas o FIFO do i2c ainda está saindo pelo barramento
+    bool pending = false;
+    bool scrolling = false;
+    bool blinking = false;
+    bool animate = false;
+    display_power_t power = DISPLAY_POWER_ON;
+    const display_step_t *step = NULL;
+    int steps_left = 0;
+    TickType_t step_due = 0;
+    TickType_t cursor_due = 0;
+    TickType_t flush_due = 0;
+
+    // A interrupção do DMA é habilitada no núcleo que executa esta task
+    ssd1306_dma_init(panel, display_dma_done);
+
+    while (true)
     {
-        buffer[i] = visible ? pswd[i] : 'x';
+        // Durante um envio só o fim do DMA (ou o seu prazo) interessa, e depois dele o esvaziamento do FIFO,
+        // conferido a cada tick; fora dele, espera também o próximo passo e o cursor. Com o painel com brilho
+        // reduzido ou desligado o cursor fica parado, sem acordar a task (e o núcleo, no tickless idle)
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = busy ? (draining ? 1 : ticks_until(flush_due, now)) : portMAX_DELAY;
+        if (!busy && steps_left > 0)
+            wait = ticks_until(step_due, now);
+        if (!busy && blinking && power == DISPLAY_POWER_ON && ticks_until(cursor_due, now) < wait)
+            wait = ticks_until(cursor_due, now);
+
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+        now = xTaskGetTickCount();
+
+        if (busy && (events & DISPLAY_EVT_DMA_DONE))
+            draining = true;
+
+        // O fim do DMA só entrega a última palavra ao FIFO: o quadro chegou quando o bloco i2c fica ocioso
+        if (busy && ((draining && ssd1306_flush_done(panel)) || ticks_until(flush_due, now) == 0))
+        {
+            bool completed = draining;
+            if (completed)
+                trace_event(TRACE_FLUSH_END, 0);
+            if (!ssd1306_flush_end(panel, completed))
+                pending = true;
+            // Um fim de envio atrasado não pode encerrar o próximo envio
+            if (!completed)
+                ulTaskNotifyValueClear(NULL, DISPLAY_EVT_DMA_DONE);
+            busy = false;
+            draining = false;
+        }
+        if (events & DISPLAY_EVT_FRAME)
+            pending = true;
+        if (events & DISPLAY_EVT_ANIMATE)
+            animate = true;
+        if (events & DISPLAY_EVT_CURSOR)
+        {
+            blinking = true;
+            cursor_due = now + pdMS_TO_TICKS(DISPLAY_CURSOR_MS);
+        }
+
+        // Comandos vão pela escrita bloqueante: só saem depois que o envio em andamento esvaziou o FIFO
+        if (busy)
+            continue;
+
+        if (power != power_request)
+        {
+            // Ao religar, a tela volta acendendo aos poucos
+            if (power == DISPLAY_POWER_OFF && power_request == DISPLAY_POWER_ON)
+            {
+                anim_request = DISPLAY_ANIM_FADE_IN;
+                animate = true;
+            }
+            power = power_request;
+            display_apply_power(power);
+
+            // Parado, o cursor fica aceso na tela com brilho reduzido; volta a piscar quando ela reacende
+            if (power == DISPLAY_POWER_ON)
+                cursor_due = now + pdMS_TO_TICKS(DISPLAY_CURSOR_MS);
+            else if (blinking && power == DISPLAY_POWER_DIM)
+            {
+                xSemaphoreTake(canvas_mutex, portMAX_DELAY);
+                if (cursor.width > 0 && !cursor.on)
+                {
+                    draw_cursor(true);
+                    pending = true;
+                }
+                xSemaphoreGive(canvas_mutex);
+            }
+        }
+
+        if (animate)
+        {
+            animate = false;
+            if (steps_left > 0)
+                display_reset_effects(power);
+            step = animations[anim_request].steps;
+            steps_left = power == DISPLAY_POWER_OFF ? 0 : animations[anim_request].count;
+            step_due = now;
+        }
+
+        // O primeiro passo sai antes do quadro pendente, para que a tela nova já apareça animada
+        if (steps_left > 0 && ticks_until(step_due, now) == 0)
+        {
+            if (scrolling)
+            {
+                display_wait_bus();
+                ssd1306_scroll_stop(panel);
+                scrolling = false;
+                pending = true;
+            }
+            display_apply_step(step, power);
+            scrolling = step->op == DISPLAY_OP_SCROLL;
+            step_due = now + pdMS_TO_TICKS(step->duration_ms);
+            step++;
+            steps_left--;
+        }
+
+        if (blinking && power == DISPLAY_POWER_ON && ticks_until(cursor_due, now) == 0)
+        {
+            xSemaphoreTake(canvas_mutex, portMAX_DELAY);
+            blinking = cursor.width > 0;
+            if (blinking)
+            {
+                draw_cursor(!cursor.on);
+                pending = true;
+            }
+            xSemaphoreGive(canvas_mutex);
+            cursor_due = now + pdMS_TO_TICKS(DISPLAY_CURSOR_MS);
+        }
+
+        if (pending)
+        {
+            // Um quadro novo encerra o scroll do controlador, que deixa a GDDRAM deslocada: a tela vai inteira
+            if (scrolling)
+            {
+                display_wait_bus();
+                ssd1306_scroll_stop(panel);
+                scrolling = false;
+            }
+
+            xSemaphoreTake(canvas_mutex, portMAX_DELAY);
+            busy = ssd1306_flush_async(panel);
+            xSemaphoreGive(canvas_mutex);
+            if (busy)
+            {
+                // Um tick a mais cobre o tick já começado
+                flush_due = xTaskGetTickCount() + pdMS_TO_TICKS(ssd1306_flush_timeout_us(panel) / 1000) + 1;
+                trace_event(TRACE_FLUSH_BEGIN, 0);
+            }
+            pending = false;
+        }
     }
-    buffer[len] = '\0';
+}
+
+// A Display Task passa a ser a dona do painel, já inicializado; as tasks desenham no framebuffer dele
+ssd1306_t *display_init(ssd1306_t *oled)
+{
+    panel = oled;
+    canvas_mutex = xSemaphoreCreateMutex();
+    xTaskCreate(task_display, "Display Task", DISPLAY_TASK_STACK, NULL, DISPLAY_TASK_PRIORITY, &display_task_handle);
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    vTaskCoreAffinitySet(display_task_handle, 1u << DISPLAY_TASK_CORE);
+#endif
+    return panel;
+}
 
-    ssd1306_draw_string(ssd, x, y, buffer);
-    render_on_display(ssd, area);
-}
\ No newline at end of file
+void display_begin()
+{
+    xSemaphoreTake(canvas_mutex, portMAX_DELAY);
+}
+
+// Libera a tela sem submeter um quadro, quando nada foi desenhado
+void display_release()
+{
+    xSemaphoreGive(canvas_mutex);
+}
+
+void display_commit()
+{
+    xSemaphoreGive(canvas_mutex);
+    trace_event(TRACE_FRAME_COMMIT, 0);
+    xTaskNotify(display_task_handle, DISPLAY_EVT_FRAME, eSetBits);
+}
+
+// Pede à Display Task o novo estado do painel; só o último pedido vale
+void display_set_power(display_power_t power)
+{
+    power_request = power;
+    xTaskNotify(display_task_handle, DISPLAY_EVT_POWER, eSetBits);
+}
+
+// Pede uma animação à Display Task; ela começa depois do envio em andamento e substitui a anterior
+void display_animate(display_anim_t anim)
+{
+    anim_request = anim;
+    xTaskNotify(display_task_handle, DISPLAY_EVT_ANIMATE, eSetBits);
+}
+
+// Move o cursor piscante para o retângulo dado (largura 0 o esconde) e o deixa aceso. Chamada com a tela
+// travada, entre display_begin e display_commit; retorna se a tela mudou
+bool display_set_cursor(int x, int y, int width, int height)
+{
+    if (cursor.x == x && cursor.y == y && cursor.width == width && cursor.height == height)
+        return false;
+
+    if (cursor.on)
+        draw_cursor(false);
+
+    cursor.x = x;
+    cursor.y = y;
+    cursor.width = width;
+    cursor.height = height;
+    if (width > 0)
+    {
+        draw_cursor(true);
+        xTaskNotify(display_task_handle, DISPLAY_EVT_CURSOR, eSetBits);
+    }
+    return true;
+}
@@ -0,0 +1,155 @@
+#include "feedback.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "trace.h"
+
+// Um passo acende os LEDs e toca o tom (0 = silêncio) por duration_ms; duration_ms 0 mantém o passo até o
+// próximo padrão
+typedef struct
+{
+    uint8_t leds;
+    uint16_t tone_hz;
+    uint16_t duration_ms;
+} feedback_step_t;
+
+static const feedback_step_t boot_steps[] = {
+    {FEEDBACK_GREEN, 0, UI_MESSAGE_MS},
+};
+
+static const feedback_step_t click_steps[] = {
+    {FEEDBACK_RED, 2500, UI_CLICK_MS},
+};
+
+static const feedback_step_t success_steps[] = {
+    {FEEDBACK_GREEN, 1000, 80},
+    {FEEDBACK_GREEN, 0, 40},
+    {FEEDBACK_GREEN, 1500, 120},
+    {FEEDBACK_GREEN, 0, UI_MESSAGE_MS},
+};
+
+static const feedback_step_t denied_steps[] = {
+    {FEEDBACK_RED, 400, 150},
+    {FEEDBACK_RED, 0, 50},
+    {FEEDBACK_RED, 400, 150},
+    {FEEDBACK_RED, 0, UI_MESSAGE_MS},
+};
+
+static const feedback_step_t lockout_steps[] = {
+    {FEEDBACK_RED, 800, 150},
+    {FEEDBACK_RED, 600, 150},
+    {FEEDBACK_RED, 400, 300},
+    {FEEDBACK_RED, 0, 0},
+};
+
+static const feedback_step_t locked_steps[] = {
+    {FEEDBACK_RED, 800, 80},
+    {FEEDBACK_RED, 0, UI_MESSAGE_MS},
+};
+
+static const feedback_step_t reset_steps[] = {
+    {FEEDBACK_BLUE, 1200, 100},
+    {FEEDBACK_BLUE, 0, UI_MESSAGE_MS},
+};
+
+static const struct
+{
+    const feedback_step_t *steps;
+    int count;
+} patterns[FEEDBACK_PATTERN_COUNT] = {
+    [FEEDBACK_BOOT] = {boot_steps, count_of(boot_steps)},
+    [FEEDBACK_CLICK] = {click_steps, count_of(click_steps)},
+    [FEEDBACK_SUCCESS] = {success_steps, count_of(success_steps)},
+    [FEEDBACK_DENIED] = {denied_steps, count_of(denied_steps)},
+    [FEEDBACK_LOCKOUT] = {lockout_steps, count_of(lockout_steps)},
+    [FEEDBACK_LOCKED] = {locked_steps, count_of(locked_steps)},
+    [FEEDBACK_RESET] = {reset_steps, count_of(reset_steps)},
+};
+
+static uint led_gpio[3];
+static uint buzzer;
+static uint buzzer_slice;
+static TimerHandle_t step_timer = NULL;
+
+// Estado do padrão em andamento; só a Timer Task o altera
+static const feedback_step_t *next_step = NULL;
+static int steps_left = 0;
+
+static void feedback_output(uint8_t leds, uint16_t tone_hz)
+{
+    for (int i = 0; i < count_of(led_gpio); i++)
+        gpio_put(led_gpio[i], (leds >> i) & 1);
+
+    if (tone_hz == 0)
+    {
+        pwm_set_gpio_level(buzzer, 0);
+        return;
+    }
+
+    uint16_t wrap = FEEDBACK_PWM_CLOCK_HZ / tone_hz - 1;
+    pwm_set_wrap(buzzer_slice, wrap);
+    pwm_set_gpio_level(buzzer, (wrap + 1) / 2);
+}
+
+static void feedback_advance()
+{
+    if (steps_left == 0)
+    {
+        feedback_output(0, 0);
+        return;
+    }
+
+    const feedback_step_t *step = next_step++;
+    steps_left--;
+    feedback_output(step->leds, step->tone_hz);
+
+    if (step->duration_ms != 0)
+        xTimerChangePeriod(step_timer, MAX(pdMS_TO_TICKS(step->duration_ms), 1), 0);
+}
+
+static void feedback_timer_callback(TimerHandle_t timer)
+{
+    feedback_advance();
+}
+
+// Executada na Timer Task: um padrão novo interrompe o anterior
+static void feedback_start(void *unused, uint32_t pattern)
+{
+    xTimerStop(step_timer, 0);
+    next_step = patterns[pattern].steps;
+    steps_left = patterns[pattern].count;
+    feedback_advance();
+}
+
+void feedback_init(uint red_gpio, uint green_gpio, uint blue_gpio, uint buzzer_gpio)
+{
+    led_gpio[0] = red_gpio;
+    led_gpio[1] = green_gpio;
+    led_gpio[2] = blue_gpio;
+
+    for (int i = 0; i < count_of(led_gpio); i++)
+    {
+        gpio_init(led_gpio[i]);
+        gpio_set_dir(led_gpio[i], GPIO_OUT);
+        gpio_put(led_gpio[i], 0);
+    }
+
+    // Buzzer passivo: onda quadrada com 50% de ciclo na frequência do tom
+    buzzer = buzzer_gpio;
+    buzzer_slice = pwm_gpio_to_slice_num(buzzer);
+    gpio_set_function(buzzer, GPIO_FUNC_PWM);
+    pwm_set_clkdiv(buzzer_slice, clock_get_hz(clk_sys) / (float)FEEDBACK_PWM_CLOCK_HZ);
+    pwm_set_gpio_level(buzzer, 0);
+    pwm_set_enabled(buzzer_slice, true);
+
+    step_timer = xTimerCreate("Feedback", 1, pdFALSE, NULL, feedback_timer_callback);
+}
+
+// Retorna na hora: o padrão é tocado pela Timer Task (se a fila dela estiver cheia, o padrão é descartado)
+void feedback_play(feedback_pattern_t pattern)
+{
+    if (pattern >= FEEDBACK_PATTERN_COUNT)
+        return;
+
+    trace_event(TRACE_FEEDBACK, pattern);
+    xTimerPendFunctionCall(feedback_start, NULL, pattern, 0);
+}
@@ -1,40 +1,392 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
 #include "flashpswd.h"
+#include "sha256.h"
+#include "pico/rand.h"
+#include "trace.h"
 
-void flash_write_pswd(const char *password, size_t length)
+static_assert(sizeof(flash_record_t) == FLASH_RECORD_SIZE, "flash_record_t deve ocupar exatamente um slot");
+static_assert(sizeof(pswd_verifier_t) <= FLASH_RECORD_DATA_SIZE, "o verificador deve caber num registro");
+static_assert(FLASH_STORE_SECTORS >= 2, "o log precisa de ao menos dois setores");
+
+// flash_relocate copia para o setor atual os verificadores vivos do setor seguinte: o setor precisa ter lugar
+// para todos eles e para a gravação que o abriu (isso também garante que o usuário caiba no byte do registro)
+static_assert(PSWD_USER_SLOTS < FLASH_RECORDS_PER_SECTOR, "os verificadores de todos os usuários devem caber num setor");
+static_assert(PSWD_USER_SLOTS <= 9, "os usuários são escolhidos pelas teclas 1 a 9");
+
+// Tabela em RAM com o verificador de cada usuário, indexada pelo próprio número do usuário. É atualizada
+// assim que a escrita é pedida; a gravação na flash fica com a Flash Task
+static pswd_verifier_t users[PSWD_USER_SLOTS];
+static bool user_valid[PSWD_USER_SLOTS];
+
+// Estado do log, usado só pela Flash Task depois da partida: slot do verificador vivo de cada usuário (-1 se nenhum)
+static int user_location[PSWD_USER_SLOTS];
+static uint32_t next_sequence = 1;
+static int next_slot = 0;
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t user;
+    uint8_t length;
+    uint8_t data[FLASH_RECORD_DATA_SIZE];
+} flash_request_t;
+
+static QueueHandle_t flash_queue = NULL;
+
+// Parâmetros das operações executadas dentro de flash_safe_execute
+typedef struct
+{
+    uint32_t offset;
+    const uint8_t *data;
+} flash_op_t;
+
+static const flash_record_t *flash_slot(int slot)
 {
-    if (length > PASSWORD_SIZE)
+    return (const flash_record_t *)(XIP_BASE + FLASH_STORE_OFFSET + slot * FLASH_RECORD_SIZE);
+}
+
+static uint32_t crc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < length; i++)
     {
-        return; // Password too long
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
     }
+    return ~crc;
+}
 
-    uint32_t ints = save_and_disable_interrupts();
-    flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
-    flash_range_program(FLASH_TARGET_OFFSET, (const uint8_t *)password, PASSWORD_SIZE);
-    restore_interrupts(ints);
+static bool record_valid(const flash_record_t *record)
+{
+    return record->magic == FLASH_RECORD_MAGIC &&
+           record->user < PSWD_USER_SLOTS &&
+           record->length <= FLASH_RECORD_DATA_SIZE &&
+           record->crc == crc32((const uint8_t *)record, offsetof(flash_record_t, crc));
 }
 
-void flash_erase_pswd(size_t length)
+static bool record_is_pswd(const flash_record_t *record)
 {
-    if (length > PASSWORD_SIZE)
+    return record->type == FLASH_RECORD_PSWD && record->length == sizeof(pswd_verifier_t);
+}
+
+static bool range_blank(const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+        if (data[i] != 0xFF)
+            return false;
+
+    return true;
+}
+
+// Percorre o log uma única vez e recupera, para cada usuário, o registro válido mais recente;
+// registros corrompidos (escrita interrompida) são ignorados
+void flash_pswd_init()
+{
+    int newest[PSWD_USER_SLOTS];
+    int last = -1;
+
+    for (int user = 0; user < PSWD_USER_SLOTS; user++)
+        newest[user] = -1;
+
+    for (int slot = 0; slot < FLASH_STORE_RECORDS; slot++)
+    {
+        const flash_record_t *record = flash_slot(slot);
+
+        if (!record_valid(record))
+            continue;
+
+        int *user_newest = &newest[record->user];
+        if (*user_newest < 0 || record->sequence > flash_slot(*user_newest)->sequence)
+            *user_newest = slot;
+
+        if (last < 0 || record->sequence > flash_slot(last)->sequence)
+            last = slot;
+    }
+
+    for (int user = 0; user < PSWD_USER_SLOTS; user++)
     {
-        return; // Password too long
+        user_valid[user] = newest[user] >= 0 && record_is_pswd(flash_slot(newest[user]));
+        user_location[user] = user_valid[user] ? newest[user] : -1;
+
+        if (user_valid[user])
+            memcpy(&users[user], flash_slot(newest[user])->data, sizeof(pswd_verifier_t));
     }
 
-    uint32_t ints = save_and_disable_interrupts();
-    flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
-    restore_interrupts(ints);
+    next_sequence = last < 0 ? 1 : flash_slot(last)->sequence + 1;
+    next_slot = last < 0 ? 0 : (last + 1) % FLASH_STORE_RECORDS;
 }
 
-bool flash_pswd_exists(const uint8_t *flash_pswd)
+static void flash_do_erase(void *param)
 {
-    for (size_t i = 0; i < PASSWORD_SIZE; i++)
-        if (flash_pswd[i] < '0' || flash_pswd[i] > '9')
+    flash_op_t *op = (flash_op_t *)param;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void flash_do_program(void *param)
+{
+    flash_op_t *op = (flash_op_t *)param;
+    flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+static int slot_sector(int slot)
+{
+    return slot / FLASH_RECORDS_PER_SECTOR;
+}
+
+static bool sector_has_live_records(int sector)
+{
+    for (int user = 0; user < PSWD_USER_SLOTS; user++)
+        if (user_location[user] >= 0 && slot_sector(user_location[user]) == sector)
+            return true;
+
+    return false;
+}
+
+// Grava o registro no próximo slot livre do log e retorna o slot usado (-1 em caso de falha). O setor só é
+// apagado quando a escrita entra nele, e nunca enquanto guardar o verificador vivo de algum usuário
+static int flash_program_record(flash_record_t *record)
+{
+    uint8_t page[FLASH_PAGE_SIZE];
+
+    record->magic = FLASH_RECORD_MAGIC;
+    record->sequence = next_sequence;
+    record->crc = crc32((const uint8_t *)record, offsetof(flash_record_t, crc));
+
+    for (int attempt = 0; attempt < FLASH_STORE_RECORDS; attempt++)
+    {
+        int slot = next_slot;
+        next_slot = (next_slot + 1) % FLASH_STORE_RECORDS;
+
+        uint32_t sector_offset = FLASH_STORE_OFFSET + slot_sector(slot) * FLASH_SECTOR_SIZE;
+        bool sector_start = (slot % FLASH_RECORDS_PER_SECTOR) == 0;
+
+        if (sector_start && !range_blank((const uint8_t *)(XIP_BASE + sector_offset), FLASH_SECTOR_SIZE))
+        {
+            if (sector_has_live_records(slot_sector(slot)))
+                return -1;
+
+            flash_op_t erase = {.offset = sector_offset};
+            if (flash_safe_execute(flash_do_erase, &erase, FLASH_SAFE_TIMEOUT_MS) != PICO_OK)
+                return -1;
+        }
+
+        // Slot já usado (escrita interrompida): pula para o próximo
+        if (!range_blank((const uint8_t *)flash_slot(slot), FLASH_RECORD_SIZE))
+            continue;
+
+        // A programação é por página; o restante da página fica em 0xFF, preservando os outros slots
+        uint32_t slot_offset = FLASH_STORE_OFFSET + slot * FLASH_RECORD_SIZE;
+        uint32_t page_offset = slot_offset & ~(FLASH_PAGE_SIZE - 1);
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page + (slot_offset - page_offset), record, sizeof(*record));
+
+        flash_op_t program = {.offset = page_offset, .data = page};
+        if (flash_safe_execute(flash_do_program, &program, FLASH_SAFE_TIMEOUT_MS) != PICO_OK)
+            return -1;
+
+        if (memcmp(flash_slot(slot), record, sizeof(*record)) != 0)
+            continue;
+
+        next_sequence++;
+        return slot;
+    }
+
+    return -1;
+}
+
+// Copia para o setor atual os verificadores vivos que estão no setor seguinte, o próximo a ser apagado.
+// Como a cópia acontece logo que a escrita entra no setor, sempre há espaço para ela; se faltar energia
+// no meio, a próxima gravação refaz o que ficou para trás
+static bool flash_relocate(int sector)
+{
+    int next = (sector + 1) % FLASH_STORE_SECTORS;
+
+    for (int user = 0; user < PSWD_USER_SLOTS; user++)
+    {
+        if (user_location[user] < 0 || slot_sector(user_location[user]) != next)
+            continue;
+
+        flash_record_t record;
+        memcpy(&record, flash_slot(user_location[user]), sizeof(record));
+
+        int slot = flash_program_record(&record);
+        if (slot < 0)
             return false;
+        user_location[user] = slot;
+    }
 
     return true;
 }
 
-bool pswd_matches(const char *input_pswd, const uint8_t *flash_pswd)
+// Registros apagados (FLASH_RECORD_ERASED) não precisam ser copiados: o verificador que eles anulam é mais
+// antigo, então está no mesmo setor ou num anterior, e é apagado junto ou antes
+static bool flash_append(uint8_t type, uint8_t user, const uint8_t *data, size_t length)
+{
+    flash_record_t record;
+
+    memset(&record, 0xFF, sizeof(record));
+    record.type = type;
+    record.user = user;
+    record.length = length;
+    memcpy(record.data, data, length);
+
+    int slot = flash_program_record(&record);
+    if (slot < 0)
+        return false;
+
+    user_location[user] = record_is_pswd(&record) ? slot : -1;
+    return flash_relocate(slot_sector(slot));
+}
+
+// Grava os pedidos em ordem, com prioridade baixa: as demais tasks seguem rodando até o instante da
+// operação na flash, e flash_safe_execute cuida das interrupções e do outro núcleo só durante ela
+static void task_flash(void *params)
+{
+    flash_request_t request;
+
+    while (true)
+    {
+        xQueueReceive(flash_queue, &request, portMAX_DELAY);
+
+        trace_event(TRACE_FLASH_BEGIN, request.type);
+        bool stored = flash_append(request.type, request.user, request.data, request.length);
+        trace_event(TRACE_FLASH_END, stored);
+
+        if (!stored)
+            printf("flash: failed to store record (type %u, user %u)\n", request.type, request.user);
+    }
+}
+
+void flash_service_init()
+{
+    flash_queue = xQueueCreate(FLASH_QUEUE_SIZE, sizeof(flash_request_t));
+    TaskHandle_t handle;
+    xTaskCreate(task_flash, "Flash Task", FLASH_TASK_STACK, NULL, FLASH_TASK_PRIORITY, &handle);
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    vTaskCoreAffinitySet(handle, 1u << FLASH_TASK_CORE);
+#endif
+}
+
+// Atualiza a tabela em RAM e enfileira a gravação, retornando sem esperar pela flash
+static void flash_request(uint8_t type, int user, const uint8_t *data, size_t length)
+{
+    flash_request_t request = {.type = type, .user = user, .length = length};
+    if (length > 0) // Sem conteúdo (FLASH_RECORD_ERASED), data é NULL: memcpy não aceita NULL nem com 0 bytes
+        memcpy(request.data, data, length);
+
+    taskENTER_CRITICAL();
+    user_valid[user] = type == FLASH_RECORD_PSWD;
+    if (user_valid[user])
+        memcpy(&users[user], data, sizeof(pswd_verifier_t));
+    taskEXIT_CRITICAL();
+
+    xQueueSend(flash_queue, &request, portMAX_DELAY);
+}
+
+// Grava apenas o verificador (sal aleatório + PBKDF2 da senha); a senha em si nunca chega à flash
+void flash_write_pswd(int user, const char *password, size_t length)
+{
+    if (user < 0 || user >= PSWD_USER_SLOTS || length < PSWD_MIN_LEN || length > PSWD_MAX_LEN)
+    {
+        return; // Invalid user or password length
+    }
+
+    pswd_verifier_t verifier = {.iterations = PSWD_KDF_ITERATIONS};
+    rng_128_t salt;
+    get_rand_128(&salt);
+    memcpy(verifier.salt, &salt, PSWD_SALT_SIZE);
+    pbkdf2_sha256((const uint8_t *)password, length, verifier.salt, PSWD_SALT_SIZE,
+                  verifier.iterations, verifier.hash, PSWD_HASH_SIZE);
+
+    flash_request(FLASH_RECORD_PSWD, user, (const uint8_t *)&verifier, sizeof(verifier));
+}
+
+void flash_erase_pswd(int user)
+{
+    if (user < 0 || user >= PSWD_USER_SLOTS)
+    {
+        return; // Invalid user
+    }
+
+    flash_request(FLASH_RECORD_ERASED, user, NULL, 0);
+}
+
+// Apaga a senha de todos os usuários cadastrados
+void flash_erase_all()
+{
+    for (int user = 0; user < PSWD_USER_SLOTS; user++)
+        if (flash_pswd_exists(user))
+            flash_erase_pswd(user);
+}
+
+bool flash_pswd_exists(int user)
+{
+    return user >= 0 && user < PSWD_USER_SLOTS && user_valid[user];
+}
+
+int flash_user_count()
+{
+    int count = 0;
+
+    for (int user = 0; user < PSWD_USER_SLOTS; user++)
+        count += user_valid[user];
+
+    return count;
+}
+
+// Compara todos os bytes sempre, sem sair no primeiro diferente
+static bool constant_time_equal(const uint8_t *a, const uint8_t *b, size_t length)
 {
-    return strncmp(input_pswd, (const char *)flash_pswd, PASSWORD_SIZE) == 0;
-}
\ No newline at end of file
+    uint8_t diff = 0;
+
+    for (size_t i = 0; i < length; i++)
+        diff |= a[i] ^ b[i];
+
+    return diff == 0;
+}
+
+// O custo é sempre uma derivação com as iterações do verificador do usuário, lido da tabela em RAM
+bool pswd_matches(int user, const char *input_pswd)
+{
+    pswd_verifier_t verifier;
+    uint8_t hash[PSWD_HASH_SIZE];
+
+    if (user < 0 || user >= PSWD_USER_SLOTS)
+        return false;
+
+    taskENTER_CRITICAL();
+    bool exists = user_valid[user];
+    memcpy(&verifier, &users[user], sizeof(verifier));
+    taskEXIT_CRITICAL();
+
+    if (!exists || verifier.iterations == 0 || verifier.iterations > PSWD_KDF_MAX_ITERATIONS)
+        return false;
+
+    trace_event(TRACE_VERIFY_BEGIN, user);
+    pbkdf2_sha256((const uint8_t *)input_pswd, strnlen(input_pswd, PSWD_MAX_LEN), verifier.salt, PSWD_SALT_SIZE,
+                  verifier.iterations, hash, PSWD_HASH_SIZE);
+
+    bool match = constant_time_equal(hash, verifier.hash, PSWD_HASH_SIZE);
+    memset(hash, 0, sizeof(hash));
+    trace_event(TRACE_VERIFY_END, match);
+    return match;
+}
+
+// Mede o custo de uma tentativa de verificação (uma derivação PBKDF2) e imprime no stdio
+void pswd_benchmark(int runs)
+{
+    uint8_t salt[PSWD_SALT_SIZE] = {0};
+    uint8_t hash[PSWD_HASH_SIZE];
+
+    uint64_t start = time_us_64();
+    for (int i = 0; i < runs; i++)
+        pbkdf2_sha256((const uint8_t *)"000000", 6, salt, PSWD_SALT_SIZE, PSWD_KDF_ITERATIONS, hash, PSWD_HASH_SIZE);
+    uint64_t elapsed = time_us_64() - start;
+
+    printf("pswd: %d iterations, %llu us per attempt (%d runs)\n",
+           PSWD_KDF_ITERATIONS, (unsigned long long)(elapsed / runs), runs);
+}
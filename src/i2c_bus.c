@@ -0,0 +1,187 @@
+#include "i2c_bus.h"
+
+// Degraus de clock, do Fast-mode Plus ao Standard-mode
+static const uint speeds_khz[] = {1000, 400, 100};
+
+static i2c_bus_t buses[I2C_BUS_COUNT];
+
+// Liga o bloco i2c ao clock atual e devolve os pinos a ele
+static void bus_start(i2c_bus_t *bus)
+{
+    i2c_init(bus->i2c, bus->khz * 1000);
+    gpio_set_function(bus->sda, GPIO_FUNC_I2C);
+    gpio_set_function(bus->scl, GPIO_FUNC_I2C);
+}
+
+// Maior degrau que não passa de khz (o menor, se nenhum)
+static uint speed_at_most(uint khz)
+{
+    for (size_t i = 0; i < count_of(speeds_khz); i++)
+        if (speeds_khz[i] <= khz)
+            return speeds_khz[i];
+
+    return speeds_khz[count_of(speeds_khz) - 1];
+}
+
+// Prepara o barramento no clock máximo pedido (limitado a 1000 kHz). Os pinos ganham pull-up e a maior
+// corrente do RP2040, que as bordas do Fast-mode Plus pedem; uma recuperação inicial solta um escravo que
+// tenha ficado preso num reset no meio de uma transação
+i2c_bus_t *i2c_bus_init(i2c_inst_t *i2c, uint sda, uint scl, uint max_khz)
+{
+    i2c_bus_t *bus = &buses[i2c_hw_index(i2c)];
+
+    *bus = (i2c_bus_t){.i2c = i2c, .sda = sda, .scl = scl, .khz = speed_at_most(max_khz), .max_khz = max_khz};
+
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    gpio_set_drive_strength(sda, GPIO_DRIVE_STRENGTH_12MA);
+    gpio_set_drive_strength(scl, GPIO_DRIVE_STRENGTH_12MA);
+
+    i2c_bus_recover(bus);
+    bus->stats.recoveries = 0;
+    return bus;
+}
+
+// Barramento do bloco index (NULL se não foi inicializado)
+i2c_bus_t *i2c_bus_get(uint index)
+{
+    return index < I2C_BUS_COUNT && buses[index].i2c ? &buses[index] : NULL;
+}
+
+// Tempo máximo de uma escrita de len bytes (mais o endereço) no clock atual: 9 bits por byte, em dobro
+uint32_t i2c_bus_timeout_us(const i2c_bus_t *bus, size_t len)
+{
+    return 2 * (len + 1) * 9 * 1000 / bus->khz + I2C_BUS_TIMEOUT_MARGIN_US;
+}
+
+// Contabiliza escritas feitas fora de i2c_bus_write (DMA alimentando o FIFO do bloco)
+void i2c_bus_count(i2c_bus_t *bus, uint32_t transactions, uint32_t bytes)
+{
+    bus->stats.transactions += transactions;
+    bus->stats.bytes += bytes;
+}
+
+// O bloco terminou tudo o que recebeu: FIFO de transmissão vazio e mestre parado (o STOP já saiu). O fim do
+// DMA não basta, pois ele só entrega a última palavra ao FIFO; um abort também esvazia o FIFO e para o mestre
+bool i2c_bus_idle(const i2c_bus_t *bus)
+{
+    uint32_t status = i2c_get_hw(bus->i2c)->status;
+    return (status & I2C_IC_STATUS_TFE_BITS) && !(status & I2C_IC_STATUS_MST_ACTIVITY_BITS);
+}
+
+// Espera o bloco ficar ocioso por até timeout_us (em passos de 1 µs); retorna false se ele continuar ocupado
+// (barramento preso)
+bool i2c_bus_wait_idle(const i2c_bus_t *bus, uint32_t timeout_us)
+{
+    for (uint32_t waited = 0; !i2c_bus_idle(bus); waited++)
+    {
+        if (waited >= timeout_us)
+            return false;
+        busy_wait_us_32(1);
+    }
+
+    return true;
+}
+
+// Sonda o escravo do clock atual para baixo: fica no primeiro degrau em que I2C_BUS_PROBE_WRITES escritas
+// de src (que não devem mudar o estado do escravo) são aceitas. Retorna false se nenhum degrau serve
+bool i2c_bus_probe(i2c_bus_t *bus, uint8_t address, const uint8_t *src, size_t len)
+{
+    for (size_t i = 0; i < count_of(speeds_khz); i++)
+    {
+        if (speeds_khz[i] > bus->khz)
+            continue;
+
+        bus->khz = speeds_khz[i];
+        i2c_set_baudrate(bus->i2c, bus->khz * 1000);
+
+        int accepted = 0;
+        while (accepted < I2C_BUS_PROBE_WRITES &&
+               i2c_write_timeout_us(bus->i2c, address, src, len, false, i2c_bus_timeout_us(bus, len)) == (int)len)
+            accepted++;
+
+        i2c_bus_count(bus, accepted, accepted * len);
+        if (accepted == I2C_BUS_PROBE_WRITES)
+            return true;
+
+        i2c_bus_recover(bus);
+    }
+
+    return false;
+}
+
+// Solta o barramento como manda a especificação i2c: com o bloco desligado, pulsa SCL (em dreno aberto,
+// via pull-up) até o escravo liberar SDA, gera um STOP e religa o bloco, que também limpa um abort pendente
+void i2c_bus_recover(i2c_bus_t *bus)
+{
+    i2c_deinit(bus->i2c);
+
+    gpio_put(bus->sda, false);
+    gpio_put(bus->scl, false);
+    gpio_set_dir(bus->sda, GPIO_IN);
+    gpio_set_dir(bus->scl, GPIO_IN);
+    gpio_set_function(bus->sda, GPIO_FUNC_SIO);
+    gpio_set_function(bus->scl, GPIO_FUNC_SIO);
+
+    for (int i = 0; i < I2C_BUS_RECOVERY_PULSES && !gpio_get(bus->sda); i++)
+    {
+        gpio_set_dir(bus->scl, GPIO_OUT);
+        busy_wait_us_32(I2C_BUS_RECOVERY_HALF_US);
+        gpio_set_dir(bus->scl, GPIO_IN);
+        busy_wait_us_32(I2C_BUS_RECOVERY_HALF_US);
+    }
+
+    // STOP: SDA sobe com SCL em nível alto
+    gpio_set_dir(bus->sda, GPIO_OUT);
+    busy_wait_us_32(I2C_BUS_RECOVERY_HALF_US);
+    gpio_set_dir(bus->sda, GPIO_IN);
+    busy_wait_us_32(I2C_BUS_RECOVERY_HALF_US);
+
+    bus_start(bus);
+    bus->stats.recoveries++;
+
+    if (bus->on_recover)
+        bus->on_recover(bus);
+}
+
+// Registra uma escrita que falhou, recupera o barramento e desce um degrau de clock
+void i2c_bus_fail(i2c_bus_t *bus, bool timeout)
+{
+    bus->stats.errors++;
+    if (timeout)
+        bus->stats.timeouts++;
+
+    uint slower = bus->khz;
+    for (size_t i = 0; i < count_of(speeds_khz) && slower == bus->khz; i++)
+        if (speeds_khz[i] < bus->khz)
+            slower = speeds_khz[i];
+
+    if (slower != bus->khz)
+    {
+        bus->khz = slower;
+        bus->stats.fallbacks++;
+    }
+
+    i2c_bus_recover(bus);
+}
+
+// Escrita com timeout (nunca bloqueia com o barramento preso). Uma falha recupera o barramento, desce o
+// clock e tenta de novo até I2C_BUS_RETRIES vezes; retorna len ou o erro da última tentativa
+int i2c_bus_write(i2c_bus_t *bus, uint8_t address, const uint8_t *src, size_t len)
+{
+    int result = PICO_ERROR_GENERIC;
+
+    for (int attempt = 0; attempt <= I2C_BUS_RETRIES; attempt++)
+    {
+        result = i2c_write_timeout_us(bus->i2c, address, src, len, false, i2c_bus_timeout_us(bus, len));
+        if (result == (int)len)
+        {
+            i2c_bus_count(bus, 1, len);
+            return result;
+        }
+
+        i2c_bus_fail(bus, result == PICO_ERROR_TIMEOUT);
+    }
+
+    return result;
+}
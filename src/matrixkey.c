@@ -1,4 +1,13 @@
 #include "matrixkey.h"
+#include "trace.h"
+
+#if KEYPAD_USE_PIO
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "keypad.pio.h"
+#endif
 
 const uint8_t ROW_PINS[ROWS_SIZE] = {18, 16, 19, 17};
 const uint8_t COL_PINS[COLS_SIZE] = {4, 20, 9};
@@ -9,84 +18,290 @@ const char keyboard_map[ROWS_SIZE][COLS_SIZE] = {
     {'7', '8', '9'},
     {'*', '0', '#'}};
 
-void init_matrix_keypad()
+#define KEYPAD_KEYS (ROWS_SIZE * COLS_SIZE)
+
+static uint button_gpio[KEYPAD_MAX_BUTTONS];
+static char button_key[KEYPAD_MAX_BUTTONS];
+static int button_count = 0;
+
+static QueueHandle_t keypad_queue = NULL;
+static TimerHandle_t scan_timer = NULL;
+
+static uint16_t stable_state = 0; // Teclas (bits 0..11) e botões (bits 12..) já confirmados
+static uint16_t last_sample = 0;
+static uint32_t edge_time_us = 0;
+
+// Em repouso todas as linhas ficam em nível baixo: qualquer tecla pressionada gera borda de descida na coluna
+static void keypad_irq_enable(bool enable)
 {
-    for (int i = 0; i < ROWS_SIZE; i++)
+    for (int c = 0; c < COLS_SIZE; c++)
+        gpio_set_irq_enabled(COL_PINS[c], GPIO_IRQ_EDGE_FALL, enable);
+
+    for (int b = 0; b < button_count; b++)
+        gpio_set_irq_enabled(button_gpio[b], GPIO_IRQ_EDGE_FALL, enable);
+}
+
+static void keypad_irq_callback(uint gpio, uint32_t events)
+{
+    BaseType_t woken = pdFALSE;
+
+    // A varredura segue na Timer Task; as interrupções voltam quando tudo for solto
+    keypad_irq_enable(false);
+    edge_time_us = time_us_32();
+    trace_event_from_isr(TRACE_KEY_EDGE, gpio);
+    xTimerStartFromISR(scan_timer, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+#if KEYPAD_USE_PIO
+
+// Última amostra das colunas para cada linha, mantida pelo DMA a partir do FIFO RX da PIO
+static uint32_t pio_samples[ROWS_SIZE] __attribute__((aligned(ROWS_SIZE * sizeof(uint32_t))));
+static uint8_t strobe_row[ROWS_SIZE]; // Linha do teclado acionada em cada passo do programa
+static uint col_base;
+static int pio_dma_channel = -1;
+
+// O DMA roda com a contagem máxima; ao final (após dias de varredura) é rearmado de onde parou
+static void keypad_dma_irq_handler()
+{
+    if (dma_channel_get_irq1_status(pio_dma_channel))
     {
-        gpio_init(ROW_PINS[i]);
-        gpio_set_dir(ROW_PINS[i], GPIO_OUT);
-        gpio_put(ROW_PINS[i], 1);
+        dma_channel_acknowledge_irq1(pio_dma_channel);
+        dma_channel_set_trans_count(pio_dma_channel, UINT32_MAX, true);
     }
+}
 
-    for (int i = 0; i < COLS_SIZE; i++)
+static void keypad_pio_init()
+{
+    uint row_base = ROW_PINS[0];
+    col_base = COL_PINS[0];
+
+    for (int i = 1; i < ROWS_SIZE; i++)
+        row_base = MIN(row_base, ROW_PINS[i]);
+    for (int c = 1; c < COLS_SIZE; c++)
+        col_base = MIN(col_base, COL_PINS[c]);
+
+    // O programa aciona as linhas como pinos consecutivos; a ordem em ROW_PINS pode ser qualquer uma
+    for (int l = 0; l < ROWS_SIZE; l++)
     {
-        gpio_init(COL_PINS[i]);
-        gpio_set_dir(COL_PINS[i], GPIO_IN);
-        gpio_pull_up(COL_PINS[i]);
+        assert(ROW_PINS[l] - row_base < ROWS_SIZE);
+        strobe_row[ROW_PINS[l] - row_base] = l;
+    }
+
+    PIO pio = pio0;
+    uint sm = pio_claim_unused_sm(pio, true);
+    uint offset = pio_add_program(pio, &keypad_program);
+    keypad_program_init(pio, sm, offset, row_base, col_base, clock_get_hz(clk_sys) / (float)KEYPAD_PIO_CLOCK_HZ);
+
+    // Anel de ROWS_SIZE palavras: a palavra k sempre recebe a amostra do passo k
+    pio_dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(pio_dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, __builtin_ctz(sizeof(pio_samples)));
+    channel_config_set_dreq(&config, pio_get_dreq(pio, sm, false));
+    dma_channel_configure(pio_dma_channel, &config, pio_samples, &pio->rxf[sm], UINT32_MAX, true);
+
+    dma_channel_set_irq1_enabled(pio_dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, keypad_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    pio_sm_set_enabled(pio, sm, true);
+}
+
+// Monta o mapa de teclas a partir das amostras mais recentes, sem tocar nos pinos
+static uint16_t keypad_scan_matrix()
+{
+    uint16_t bitmap = 0;
+
+    for (int k = 0; k < ROWS_SIZE; k++)
+    {
+        uint32_t sample = pio_samples[k];
+
+        for (int c = 0; c < COLS_SIZE; c++)
+            if (!(sample & (1u << (COL_PINS[c] - col_base))))
+                bitmap |= 1u << (strobe_row[k] * COLS_SIZE + c);
     }
+
+    return bitmap;
 }
 
-char read_digit(const uint8_t *rows, const uint8_t *cols)
+#else
+
+// Varre a matriz linha a linha, retornando um bit por tecla pressionada
+static uint16_t keypad_scan_matrix()
 {
+    uint16_t bitmap = 0;
+
     for (int l = 0; l < ROWS_SIZE; l++)
     {
         for (int i = 0; i < ROWS_SIZE; i++)
-            gpio_put(ROW_PINS[i], 1);
+            gpio_put(ROW_PINS[i], i != l);
 
-        gpio_put(ROW_PINS[l], 0);
         sleep_us(3);
 
         for (int c = 0; c < COLS_SIZE; c++)
-        {
             if (gpio_get(COL_PINS[c]) == 0)
-            {
-                while (gpio_get(COL_PINS[c]) == 0)
-                    tight_loop_contents();
-
-                return keyboard_map[l][c];
-            }
-        }
+                bitmap |= 1u << (l * COLS_SIZE + c);
     }
-    return '\0';
+
+    for (int i = 0; i < ROWS_SIZE; i++)
+        gpio_put(ROW_PINS[i], 0);
+
+    return bitmap;
 }
 
-void click_feedback(uint led_gpio, uint buzzer_gpio, uint delay_ms) {
-    gpio_put(led_gpio, 1);
-    gpio_put(buzzer_gpio, 1);
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
-    gpio_put(led_gpio, 0);
-    gpio_put(buzzer_gpio, 0);
+#endif
+
+// Estado atual de teclas (bits 0..11, linha * COLS_SIZE + coluna) e botões (bits 12..), sem debounce
+uint16_t keypad_get_bitmap()
+{
+    uint16_t bitmap = keypad_scan_matrix();
+
+    for (int b = 0; b < button_count; b++)
+        if (gpio_get(button_gpio[b]) == 0)
+            bitmap |= 1u << (KEYPAD_KEYS + b);
+
+    return bitmap;
 }
 
-/* bool read_matrix_step(char *pswd, size_t pswd_size,int *idx, uint led_gpio, uint buzzer_gpio)
+// Sem diodos, três teclas nos cantos de um retângulo fazem a quarta parecer pressionada:
+// duas linhas com duas ou mais colunas em comum tornam a leitura ambígua
+bool keypad_ghosted(uint16_t bitmap)
 {
-    char digit = read_digit(ROW_PINS, COL_PINS);
-    if (digit != '\0' && *idx < pswd_size)
+    const uint16_t row_mask = (1u << COLS_SIZE) - 1;
+
+    for (int a = 0; a < ROWS_SIZE; a++)
     {
-        pswd[*idx] = digit;
-        (*idx)++;
-        pswd[*idx] = '\0';
-        click_feedback(led_gpio, buzzer_gpio, 100);
-        return true; // houve atualização
+        for (int b = a + 1; b < ROWS_SIZE; b++)
+        {
+            uint16_t common = (bitmap >> (a * COLS_SIZE)) & (bitmap >> (b * COLS_SIZE)) & row_mask;
+            if (common & (common - 1))
+                return true;
+        }
     }
-    return false; // nada lido
+    return false;
+}
+
+static char keypad_bit_to_key(int bit)
+{
+    if (bit < KEYPAD_KEYS)
+        return keyboard_map[bit / COLS_SIZE][bit % COLS_SIZE];
+
+    return button_key[bit - KEYPAD_KEYS];
 }
- */
-/* void read_matrix(char *pswd, const char *msg, uint led_gpio, uint buzzer_gpio)
+
+// Debounce: uma mudança só é publicada depois de duas varreduras seguidas iguais e sem ambiguidade;
+// várias teclas podem mudar na mesma varredura (rollover), cada uma gerando seu evento
+static void keypad_scan_callback(TimerHandle_t timer)
 {
-    int idx = 0;
-    char digit;
+    uint16_t sample = keypad_get_bitmap();
+    uint32_t now = time_us_32();
 
-    while (idx < PASSWORD_SIZE)
+    if (sample == last_sample && sample != stable_state && !keypad_ghosted(sample))
     {
-        digit = read_digit(ROW_PINS, COL_PINS);
-        if (digit != '\0')
+        uint16_t changed = sample ^ stable_state;
+
+        for (int bit = 0; bit < KEYPAD_KEYS + button_count; bit++)
         {
-            pswd[idx++] = digit;
-            click_feedback(led_gpio, buzzer_gpio, 100);
+            if (!(changed & (1u << bit)))
+                continue;
+
+            keypad_event_t event = {
+                .key = keypad_bit_to_key(bit),
+                .pressed = (sample & (1u << bit)) != 0,
+                .time_us = (stable_state == 0) ? edge_time_us : now,
+            };
+            trace_event(TRACE_KEY_EVENT, (uint8_t)event.key | event.pressed << 8);
+            xQueueSend(keypad_queue, &event, 0);
         }
-        vTaskDelay(pdMS_TO_TICKS(50));
+        stable_state = sample;
     }
-    pswd[idx] = '\0'; 
-} */
+    last_sample = sample;
+
+    if (sample == 0 && stable_state == 0)
+    {
+        xTimerStop(timer, 0);
+
+        for (int c = 0; c < COLS_SIZE; c++)
+            gpio_acknowledge_irq(COL_PINS[c], GPIO_IRQ_EDGE_FALL);
+        for (int b = 0; b < button_count; b++)
+            gpio_acknowledge_irq(button_gpio[b], GPIO_IRQ_EDGE_FALL);
 
+        keypad_irq_enable(true);
+
+        // Tecla pressionada entre a última varredura e a reativação: a borda já foi descartada
+        if (keypad_get_bitmap() != 0)
+        {
+            keypad_irq_enable(false);
+            edge_time_us = time_us_32();
+            xTimerStart(timer, 0);
+        }
+    }
+}
+
+void init_matrix_keypad()
+{
+#if KEYPAD_USE_PIO
+    keypad_pio_init();
+#else
+    for (int i = 0; i < ROWS_SIZE; i++)
+    {
+        gpio_init(ROW_PINS[i]);
+        gpio_set_dir(ROW_PINS[i], GPIO_OUT);
+        gpio_put(ROW_PINS[i], 0);
+    }
+#endif
+
+    for (int i = 0; i < COLS_SIZE; i++)
+    {
+        gpio_init(COL_PINS[i]);
+        gpio_set_dir(COL_PINS[i], GPIO_IN);
+        gpio_pull_up(COL_PINS[i]);
+    }
+
+    keypad_queue = xQueueCreate(KEYPAD_QUEUE_SIZE, sizeof(keypad_event_t));
+    scan_timer = xTimerCreate("Keypad Scan", pdMS_TO_TICKS(KEYPAD_SCAN_MS), pdTRUE, NULL, keypad_scan_callback);
+
+    gpio_set_irq_enabled_with_callback(COL_PINS[0], GPIO_IRQ_EDGE_FALL, true, keypad_irq_callback);
+    keypad_irq_enable(true);
+}
+
+// Registra um botão (com pull-up, ativo em nível baixo) cujos eventos chegam na mesma fila do teclado
+void keypad_add_button(uint gpio, char key)
+{
+    if (button_count >= KEYPAD_MAX_BUTTONS)
+        return;
+
+    button_gpio[button_count] = gpio;
+    button_key[button_count] = key;
+    button_count++;
+
+    gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL, true);
+}
+
+bool keypad_get_event(keypad_event_t *event, TickType_t timeout)
+{
+    return xQueueReceive(keypad_queue, event, timeout) == pdTRUE;
+}
+
+// Espera até uma tecla ou botão ser pressionado, sem retirar o evento da fila; as solturas no caminho são
+// descartadas. Retorna false se o tempo acabar
+bool keypad_wait_press(TickType_t timeout)
+{
+    TickType_t start = xTaskGetTickCount();
+    keypad_event_t event;
+
+    while (true)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed > timeout || xQueuePeek(keypad_queue, &event, timeout - elapsed) != pdTRUE)
+            return false;
+
+        if (event.pressed)
+            return true;
+
+        xQueueReceive(keypad_queue, &event, 0);
+    }
+}
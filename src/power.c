@@ -0,0 +1,95 @@
+#include <assert.h>
+#include "power.h"
+#include "display.h"
+
+static_assert(POWER_DIM_MS < POWER_OFF_MS, "o display reduz o brilho antes de desligar");
+
+static TimerHandle_t idle_timer = NULL;
+static display_power_t display_power = DISPLAY_POWER_ON;
+static bool held = false; // power_hold: a contagem de inatividade não apaga mais o display
+
+// Tempo acumulado em WFI pelo tickless idle (configPRE/POST_SLEEP_PROCESSING, com interrupções desligadas)
+static volatile uint64_t asleep_us = 0;
+static uint64_t sleep_start_us = 0;
+
+// Na Timer Task: primeiro reduz o brilho, depois desliga o painel
+static void power_idle_callback(TimerHandle_t timer)
+{
+    taskENTER_CRITICAL();
+    if (held)
+    {
+        taskEXIT_CRITICAL();
+        return;
+    }
+    display_power_t next = display_power == DISPLAY_POWER_ON ? DISPLAY_POWER_DIM : DISPLAY_POWER_OFF;
+    display_power = next;
+    taskEXIT_CRITICAL();
+
+    display_set_power(next);
+    if (next == DISPLAY_POWER_DIM)
+        xTimerChangePeriod(timer, pdMS_TO_TICKS(POWER_OFF_MS - POWER_DIM_MS), 0);
+}
+
+void power_init()
+{
+    idle_timer = xTimerCreate("Idle", pdMS_TO_TICKS(POWER_DIM_MS), pdFALSE, NULL, power_idle_callback);
+    xTimerStart(idle_timer, 0);
+}
+
+// Chamada pelas tasks da interface a cada tecla: religa o display e reinicia a contagem de inatividade.
+// Retorna true se o display estava desligado, para que a tecla que o acordou seja descartada (sem
+// power_init, não faz nada)
+bool power_activity()
+{
+    if (idle_timer == NULL)
+        return false;
+
+    taskENTER_CRITICAL();
+    bool was_off = display_power == DISPLAY_POWER_OFF;
+    bool changed = display_power != DISPLAY_POWER_ON;
+    display_power = DISPLAY_POWER_ON;
+    taskEXIT_CRITICAL();
+
+    if (changed)
+        display_set_power(DISPLAY_POWER_ON);
+    xTimerChangePeriod(idle_timer, pdMS_TO_TICKS(POWER_DIM_MS), portMAX_DELAY);
+
+    return was_off;
+}
+
+// Mantém o display aceso de vez, para telas que ficam sem leitura do teclado (LOCKED OUT): religa o painel se
+// preciso e para a contagem de inatividade. O núcleo continua dormindo entre os eventos
+void power_hold()
+{
+    if (idle_timer == NULL)
+        return;
+
+    taskENTER_CRITICAL();
+    bool changed = display_power != DISPLAY_POWER_ON;
+    display_power = DISPLAY_POWER_ON;
+    held = true;
+    taskEXIT_CRITICAL();
+
+    if (changed)
+        display_set_power(DISPLAY_POWER_ON);
+    xTimerStop(idle_timer, portMAX_DELAY);
+}
+
+void power_sleep_enter()
+{
+    sleep_start_us = time_us_64();
+}
+
+void power_sleep_exit()
+{
+    asleep_us += time_us_64() - sleep_start_us;
+}
+
+// Tempo total dormindo e desde a partida; sem LOW_POWER o núcleo nunca dorme e asleep_us fica em 0
+void power_sleep_stats(uint64_t *asleep, uint64_t *uptime)
+{
+    taskENTER_CRITICAL();
+    *asleep = asleep_us;
+    taskEXIT_CRITICAL();
+    *uptime = time_us_64();
+}
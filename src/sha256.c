@@ -0,0 +1,205 @@
+#include <string.h>
+#include "sha256.h"
+
+static const uint32_t k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_compress(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE])
+{
+    uint32_t w[64];
+
+    for (int i = 0; i < 16; i++)
+        w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 | (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+
+    for (int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void sha256_init(sha256_ctx_t *ctx)
+{
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, size_t length)
+{
+    ctx->length += length;
+
+    while (length > 0)
+    {
+        size_t chunk = SHA256_BLOCK_SIZE - ctx->used;
+        if (chunk > length)
+            chunk = length;
+
+        memcpy(ctx->block + ctx->used, data, chunk);
+        ctx->used += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (ctx->used == SHA256_BLOCK_SIZE)
+        {
+            sha256_compress(ctx->state, ctx->block);
+            ctx->used = 0;
+        }
+    }
+}
+
+void sha256_final(sha256_ctx_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    uint64_t bits = ctx->length * 8;
+
+    ctx->block[ctx->used++] = 0x80;
+    if (ctx->used > SHA256_BLOCK_SIZE - 8)
+    {
+        memset(ctx->block + ctx->used, 0, SHA256_BLOCK_SIZE - ctx->used);
+        sha256_compress(ctx->state, ctx->block);
+        ctx->used = 0;
+    }
+    memset(ctx->block + ctx->used, 0, SHA256_BLOCK_SIZE - 8 - ctx->used);
+
+    for (int i = 0; i < 8; i++)
+        ctx->block[SHA256_BLOCK_SIZE - 1 - i] = bits >> (8 * i);
+    sha256_compress(ctx->state, ctx->block);
+
+    for (int i = 0; i < 8; i++)
+    {
+        digest[4 * i] = ctx->state[i] >> 24;
+        digest[4 * i + 1] = ctx->state[i] >> 16;
+        digest[4 * i + 2] = ctx->state[i] >> 8;
+        digest[4 * i + 3] = ctx->state[i];
+    }
+}
+
+// Contextos com a chave já absorvida (ipad/opad), reaproveitados a cada iteração do PBKDF2
+typedef struct
+{
+    sha256_ctx_t inner;
+    sha256_ctx_t outer;
+} hmac_key_t;
+
+static void hmac_key_init(hmac_key_t *hmac, const uint8_t *key, size_t key_length)
+{
+    uint8_t pad[SHA256_BLOCK_SIZE] = {0};
+
+    if (key_length > SHA256_BLOCK_SIZE)
+    {
+        sha256_init(&hmac->inner);
+        sha256_update(&hmac->inner, key, key_length);
+        sha256_final(&hmac->inner, pad);
+    }
+    else
+    {
+        memcpy(pad, key, key_length);
+    }
+
+    for (int i = 0; i < SHA256_BLOCK_SIZE; i++)
+        pad[i] ^= 0x36;
+    sha256_init(&hmac->inner);
+    sha256_update(&hmac->inner, pad, SHA256_BLOCK_SIZE);
+
+    for (int i = 0; i < SHA256_BLOCK_SIZE; i++)
+        pad[i] ^= 0x36 ^ 0x5c;
+    sha256_init(&hmac->outer);
+    sha256_update(&hmac->outer, pad, SHA256_BLOCK_SIZE);
+
+    memset(pad, 0, sizeof(pad));
+}
+
+static void hmac_compute(const hmac_key_t *hmac, const uint8_t *data, size_t data_length, uint8_t mac[SHA256_DIGEST_SIZE])
+{
+    sha256_ctx_t ctx = hmac->inner;
+    sha256_update(&ctx, data, data_length);
+    sha256_final(&ctx, mac);
+
+    ctx = hmac->outer;
+    sha256_update(&ctx, mac, SHA256_DIGEST_SIZE);
+    sha256_final(&ctx, mac);
+}
+
+void hmac_sha256(const uint8_t *key, size_t key_length, const uint8_t *data, size_t data_length, uint8_t mac[SHA256_DIGEST_SIZE])
+{
+    hmac_key_t hmac;
+    hmac_key_init(&hmac, key, key_length);
+    hmac_compute(&hmac, data, data_length, mac);
+}
+
+// PBKDF2 (RFC 8018) com HMAC-SHA256; cada iteração custa duas compressões SHA-256
+void pbkdf2_sha256(const uint8_t *password, size_t password_length, const uint8_t *salt, size_t salt_length,
+                   uint32_t iterations, uint8_t *out, size_t out_length)
+{
+    hmac_key_t hmac;
+    hmac_key_init(&hmac, password, password_length);
+
+    for (uint32_t block = 1; out_length > 0; block++)
+    {
+        uint8_t u[SHA256_DIGEST_SIZE];
+        uint8_t t[SHA256_DIGEST_SIZE];
+        uint8_t index[4] = {block >> 24, block >> 16, block >> 8, block};
+
+        sha256_ctx_t ctx = hmac.inner;
+        sha256_update(&ctx, salt, salt_length);
+        sha256_update(&ctx, index, sizeof(index));
+        sha256_final(&ctx, u);
+        ctx = hmac.outer;
+        sha256_update(&ctx, u, SHA256_DIGEST_SIZE);
+        sha256_final(&ctx, u);
+        memcpy(t, u, SHA256_DIGEST_SIZE);
+
+        for (uint32_t i = 1; i < iterations; i++)
+        {
+            hmac_compute(&hmac, u, SHA256_DIGEST_SIZE, u);
+            for (int j = 0; j < SHA256_DIGEST_SIZE; j++)
+                t[j] ^= u[j];
+        }
+
+        size_t chunk = out_length < SHA256_DIGEST_SIZE ? out_length : SHA256_DIGEST_SIZE;
+        memcpy(out, t, chunk);
+        out += chunk;
+        out_length -= chunk;
+    }
+
+    memset(&hmac, 0, sizeof(hmac));
+}
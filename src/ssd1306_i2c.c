@@ -1,98 +1,437 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "ssd1306_font.h"
 #include "ssd1306_i2c.h"
 
+// Painéis inicializados: a interrupção do DMA e a ressincronização após uma recuperação do barramento
+// procuram aqui o painel de cada canal e de cada barramento
+static ssd1306_t *devices[ssd1306_max_devices];
+static int device_count = 0;
+
 // Calcular quanto do buffer será destinado à área de renderização
 void calculate_render_area_buffer_length(struct render_area *area) {
     area->buffer_length = (area->end_column - area->start_column + 1) * (area->end_page - area->start_page + 1);
 }
 
-// Processo de escrita do i2c espera um byte de controle, seguido por dados
-void ssd1306_send_command(uint8_t command) {
-    uint8_t buffer[2] = {0x80, command};
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, buffer, 2, false);
+// Escrita pelo gerenciador do barramento. Uma falha, mesmo recuperada numa nova tentativa, pode ter deixado
+// os ponteiros de coluna e página do painel fora do lugar: a cópia do painel deixa de valer e o próximo
+// flush reenvia a tela inteira
+static void bus_write(ssd1306_t *ssd, const uint8_t *src, size_t len) {
+    uint32_t errors = ssd->bus->stats.errors;
+
+    i2c_bus_write(ssd->bus, ssd->address, src, len);
+    if (ssd->bus->stats.errors != errors) {
+        ssd->shadow_valid = false;
+    }
 }
 
-// Envia uma lista de comandos ao hardware
-void ssd1306_send_command_list(uint8_t *ssd, int number) {
-    for (int i = 0; i < number; i++) {
-        ssd1306_send_command(ssd[i]);
+// Uma transação interrompida pode deixar o SSD1306 esperando os argumentos de um comando pela metade, e
+// ele engoliria os primeiros bytes da nova tentativa: NOPs em número do maior comando (6 argumentos)
+// esgotam a espera, em cada painel do barramento. Escrita direta, sem as novas tentativas do gerenciador
+static void resync_panels(i2c_bus_t *bus) {
+    const uint8_t nops[] = {0x00, ssd1306_nop, ssd1306_nop, ssd1306_nop, ssd1306_nop, ssd1306_nop, ssd1306_nop};
+
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i]->bus == bus) {
+            i2c_write_timeout_us(bus->i2c, devices[i]->address, nops, sizeof(nops), false,
+                                 i2c_bus_timeout_us(bus, sizeof(nops)));
+        }
     }
 }
 
-// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
-void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
+// Comando avulso: byte de controle 0x80 (Co=1, D/C#=0) seguido do comando
+void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+    uint8_t buffer[2] = {0x80, command};
+    bus_write(ssd, buffer, 2);
+}
 
-    temp_buffer[0] = 0x40;
-    memcpy(temp_buffer + 1, ssd, buffer_length);
+// Envia uma lista de comandos numa única transação: byte de controle 0x00 (Co=0, D/C#=0) seguido dos comandos
+void ssd1306_send_command_list(ssd1306_t *ssd, const uint8_t *commands, int number) {
+    uint8_t buffer[ssd1306_command_batch + 1];
+
+    buffer[0] = 0x00;
+    while (number > 0) {
+        int chunk = number > ssd1306_command_batch ? ssd1306_command_batch : number;
+        memcpy(buffer + 1, commands, chunk);
+        bus_write(ssd, buffer, chunk + 1);
+        commands += chunk;
+        number -= chunk;
+    }
+}
 
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
+// Envia um trecho do framebuffer numa única transação, sem cópia: o byte de controle de dados (0x40) é
+// escrito temporariamente na posição anterior ao trecho (ram_buffer reserva o byte antes do framebuffer)
+static void send_data(ssd1306_t *ssd, uint8_t *data, int length) {
+    assert(data >= ssd->buffer && data + length <= ssd->buffer + ssd->bufsize);
 
-    free(temp_buffer);
+    uint8_t saved = data[-1];
+    data[-1] = 0x40;
+    bus_write(ssd, data - 1, length + 1);
+    data[-1] = saved;
 }
 
-// Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
-void ssd1306_init() {
+// Configuração do controlador para a geometria do painel: endereçamento horizontal, multiplex da altura,
+// pinos COM (sequenciais em 128x32, alternados em 128x64) e a alimentação interna ou externa
+void ssd1306_config(ssd1306_t *ssd) {
     uint8_t commands[] = {
         ssd1306_set_display, ssd1306_set_memory_mode, 0x00,
-        ssd1306_set_display_start_line, ssd1306_set_segment_remap | 0x01, 
-        ssd1306_set_mux_ratio, ssd1306_height - 1,
+        ssd1306_set_display_start_line, ssd1306_set_segment_remap | 0x01,
+        ssd1306_set_mux_ratio, ssd->height - 1,
         ssd1306_set_common_output_direction | 0x08, ssd1306_set_display_offset,
-        0x00, ssd1306_set_common_pin_configuration,
-    
-#if ((ssd1306_width == 128) && (ssd1306_height == 32))
-    0x02,
-#elif ((ssd1306_width == 128) && (ssd1306_height == 64))
-    0x12,
-#else
-    0x02,
-#endif
+        0x00, ssd1306_set_common_pin_configuration, ssd->height == 32 ? 0x02 : 0x12,
         ssd1306_set_display_clock_divide_ratio, 0x80, ssd1306_set_precharge,
-        0xF1, ssd1306_set_vcomh_deselect_level, 0x30, ssd1306_set_contrast,
+        ssd->external_vcc ? 0x22 : 0xF1, ssd1306_set_vcomh_deselect_level, 0x30, ssd1306_set_contrast,
         0xFF, ssd1306_set_entire_on, ssd1306_set_normal_display,
-        ssd1306_set_charge_pump, 0x14, ssd1306_set_scroll | 0x00,
+        ssd1306_set_charge_pump, ssd->external_vcc ? 0x10 : 0x14, ssd1306_set_scroll | 0x00,
         ssd1306_set_display | 0x01,
     };
 
-    ssd1306_send_command_list(commands, count_of(commands));
+    ssd1306_send_command_list(ssd, commands, count_of(commands));
+}
+
+// Prepara o painel (128x64 ou 128x32) no barramento, sonda o clock mais alto que ele aceita com comandos NOP
+// e envia a configuração. Chamada uma vez por painel; retorna false se o painel não responde nem no clock
+// mais baixo
+bool ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_bus_t *bus) {
+    const uint8_t nop[] = {0x80, ssd1306_nop};
+
+    assert(width <= ssd1306_max_width && height <= ssd1306_max_height && height % ssd1306_page_height == 0);
+
+    memset(ssd, 0, sizeof(*ssd));
+    ssd->width = width;
+    ssd->height = height;
+    ssd->pages = height / ssd1306_page_height;
+    ssd->address = address;
+    ssd->bus = bus;
+    ssd->external_vcc = external_vcc;
+    ssd->ram_buffer[0] = 0x40;
+    ssd->buffer = ssd->ram_buffer + 1;
+    ssd->bufsize = ssd->width * ssd->pages;
+    ssd->dma_channel = -1;
+
+    int i = 0;
+    while (i < device_count && devices[i] != ssd) i++;
+    if (i == device_count) {
+        assert(device_count < ssd1306_max_devices);
+        devices[device_count++] = ssd;
+    }
+    bus->on_recover = resync_panels;
+
+    bool answered = i2c_bus_probe(bus, address, nop, sizeof(nop));
+    ssd1306_config(ssd);
+    return answered;
+}
+
+// Liga ou desliga o painel (modo sleep do SSD1306, que mantém a GDDRAM)
+void ssd1306_power(ssd1306_t *ssd, bool on) {
+    ssd1306_command(ssd, ssd1306_set_display | (on ? 0x01 : 0x00));
 }
 
-// Cria a lista de comandos para configurar o scrolling
-void ssd1306_scroll(bool set) {
+// Ajusta o brilho (corrente dos segmentos); o ssd1306_config usa 0xFF
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t contrast) {
+    uint8_t commands[] = {ssd1306_set_contrast, contrast};
+
+    ssd1306_send_command_list(ssd, commands, count_of(commands));
+}
+
+// Inverte o painel inteiro (pixels acesos apagam e vice-versa) sem mexer na GDDRAM
+void ssd1306_invert(ssd1306_t *ssd, bool inverted) {
+    ssd1306_command(ssd, inverted ? ssd1306_set_inverse_display : ssd1306_set_normal_display);
+}
+
+// Escolhe a linha da GDDRAM mostrada no topo do painel: a imagem rola na vertical (dando a volta) sem reenviar
+// dados. A linha é tomada módulo a altura, então (uint8_t)-n sobe a imagem n linhas em qualquer painel
+void ssd1306_start_line(ssd1306_t *ssd, uint8_t line) {
+    ssd1306_command(ssd, ssd1306_set_display_start_line | (line % ssd->height));
+}
+
+// Rola as páginas [start_page, end_page] na horizontal pelo próprio controlador, uma coluna a cada intervalo
+// (ssd1306_scroll_frames_*). O scroll anterior é parado antes, como pede o datasheet
+void ssd1306_scroll_pages(ssd1306_t *ssd, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval) {
     uint8_t commands[] = {
-        ssd1306_set_horizontal_scroll | 0x00, 0x00, 0x00, 0x00, 0x03,
-        0x00, 0xFF, ssd1306_set_scroll | (set ? 0x01 : 0)
+        ssd1306_set_scroll | 0x00,
+        ssd1306_set_horizontal_scroll | (left ? 0x01 : 0x00), 0x00, start_page, interval, end_page, 0x00, 0xFF,
+        ssd1306_set_scroll | 0x01,
     };
 
-    ssd1306_send_command_list(commands, count_of(commands));
+    ssd1306_send_command_list(ssd, commands, count_of(commands));
+}
+
+// Para o scroll; o controlador deixa a GDDRAM deslocada, então o próximo flush reenvia a tela inteira
+void ssd1306_scroll_stop(ssd1306_t *ssd) {
+    ssd1306_command(ssd, ssd1306_set_scroll | 0x00);
+    ssd->shadow_valid = false;
+}
+
+// Liga ou desliga o scrolling das páginas 0 a 3 para a direita
+void ssd1306_scroll(ssd1306_t *ssd, bool set) {
+    if (set) {
+        ssd1306_scroll_pages(ssd, false, 0, 3, ssd1306_scroll_frames_5);
+    }
+    else {
+        ssd1306_scroll_stop(ssd);
+    }
 }
 
-// Atualiza uma parte do display com uma área de renderização
-void render_on_display(uint8_t *ssd, struct render_area *area) {
+// Envia ao display uma área do framebuffer: numa transação só se a área ocupa a largura toda (as páginas
+// são contíguas no framebuffer), senão uma por página, continuando na janela de colunas do controlador
+void render_on_display(ssd1306_t *ssd, struct render_area *area) {
+    uint32_t errors = ssd->bus->stats.errors;
+    int width = area->end_column - area->start_column + 1;
     uint8_t commands[] = {
         ssd1306_set_column_address, area->start_column, area->end_column,
         ssd1306_set_page_address, area->start_page, area->end_page
     };
 
-    ssd1306_send_command_list(commands, count_of(commands));
-    ssd1306_send_buffer(ssd, area->buffer_length);
+    ssd1306_send_command_list(ssd, commands, count_of(commands));
+    if (width == ssd->width) {
+        send_data(ssd, ssd->buffer + area->start_page * ssd->width, width * (area->end_page - area->start_page + 1));
+    }
+    else {
+        for (int page = area->start_page; page <= area->end_page; page++) {
+            send_data(ssd, ssd->buffer + page * ssd->width + area->start_column, width);
+        }
+    }
+
+    // Mantém a cópia do painel coerente com a área enviada
+    for (int page = area->start_page; page <= area->end_page; page++) {
+        memcpy(ssd->shadow + page * ssd->width + area->start_column, ssd->buffer + page * ssd->width + area->start_column, width);
+    }
+    if (area->start_column == 0 && area->end_column == ssd->width - 1 &&
+        area->start_page == 0 && area->end_page == ssd->pages - 1 && ssd->bus->stats.errors == errors) {
+        ssd->shadow_valid = true;
+        memset(ssd->dirty_start, 0, sizeof(ssd->dirty_start));
+        memset(ssd->dirty_end, 0, sizeof(ssd->dirty_end));
+    }
 }
 
-// Determina o pixel a ser aceso (no display) de acordo com a coordenada fornecida
-void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
-    assert(x >= 0 && x < ssd1306_width && y >= 0 && y < ssd1306_height);
+// Marca como alterada a região de pixels [x_0, x_1] x [y_0, y_1] (coordenadas já recortadas ao display)
+static void mark_dirty_region(ssd1306_t *ssd, int x_0, int y_0, int x_1, int y_1) {
+    for (int page = y_0 / 8; page <= y_1 / 8; page++) {
+        if (ssd->dirty_start[page] >= ssd->dirty_end[page]) {
+            ssd->dirty_start[page] = x_0;
+            ssd->dirty_end[page] = x_1 + 1;
+        }
+        else {
+            if (x_0 < ssd->dirty_start[page]) ssd->dirty_start[page] = x_0;
+            if (x_1 + 1 > ssd->dirty_end[page]) ssd->dirty_end[page] = x_1 + 1;
+        }
+    }
+}
+
+// Marca um retângulo (em pixels) como alterado, para ser enviado no próximo ssd1306_flush
+void ssd1306_mark_dirty(ssd1306_t *ssd, int x, int y, int width, int height) {
+    int x_0 = x < 0 ? 0 : x;
+    int y_0 = y < 0 ? 0 : y;
+    int x_1 = x + width - 1 >= ssd->width ? ssd->width - 1 : x + width - 1;
+    int y_1 = y + height - 1 >= ssd->height ? ssd->height - 1 : y + height - 1;
+
+    if (x_0 > x_1 || y_0 > y_1) {
+        return;
+    }
+
+    mark_dirty_region(ssd, x_0, y_0, x_1, y_1);
+}
+
+// Limpa o framebuffer inteiro e marca todas as páginas como alteradas
+void ssd1306_clear(ssd1306_t *ssd) {
+    memset(ssd->buffer, 0, ssd->bufsize);
+    mark_dirty_region(ssd, 0, 0, ssd->width - 1, ssd->height - 1);
+}
+
+// Retira a marcação de uma página e calcula o trecho [início, fim) a enviar, descartando as bordas que
+// já estão no painel; a cópia do painel é atualizada, pois o trecho será enviado em seguida
+static bool take_dirty_span(ssd1306_t *ssd, int page, int *span_start, int *span_end) {
+    int start = ssd->dirty_start[page];
+    int end = ssd->dirty_end[page];
+    ssd->dirty_start[page] = ssd->dirty_end[page] = 0;
+
+    const uint8_t *row = ssd->buffer + page * ssd->width;
+    uint8_t *shadow_row = ssd->shadow + page * ssd->width;
+
+    if (!ssd->shadow_valid) {
+        start = 0;
+        end = ssd->width;
+    }
+    else {
+        while (start < end && row[start] == shadow_row[start]) start++;
+        while (end > start && row[end - 1] == shadow_row[end - 1]) end--;
+    }
+
+    if (start >= end) {
+        return false;
+    }
+
+    memcpy(shadow_row + start, row + start, end - start);
+    *span_start = start;
+    *span_end = end;
+    return true;
+}
+
+// Envia ao display apenas as colunas alteradas de cada página, descartando as bordas que já estão no painel
+void ssd1306_flush(ssd1306_t *ssd) {
+    uint32_t errors = ssd->bus->stats.errors;
+    int start, end;
+
+    for (int page = 0; page < ssd->pages; page++) {
+        if (!take_dirty_span(ssd, page, &start, &end)) {
+            continue;
+        }
+
+        uint8_t commands[] = {
+            ssd1306_set_column_address, start, end - 1,
+            ssd1306_set_page_address, page, page
+        };
+
+        ssd1306_send_command_list(ssd, commands, count_of(commands));
+        send_data(ssd, ssd->buffer + page * ssd->width + start, end - start);
+    }
+
+    // Uma página que falhou já foi copiada para a cópia do painel: só um envio sem erros a valida
+    ssd->shadow_valid = ssd->bus->stats.errors == errors;
+}
+
+// Uma interrupção compartilhada atende os canais de todos os painéis
+static void dma_irq_handler() {
+    for (int i = 0; i < device_count; i++) {
+        ssd1306_t *ssd = devices[i];
+        if (ssd->dma_channel >= 0 && dma_channel_get_irq0_status(ssd->dma_channel)) {
+            dma_channel_acknowledge_irq0(ssd->dma_channel);
+            if (ssd->dma_done) {
+                ssd->dma_done(ssd);
+            }
+        }
+    }
+}
+
+// Prepara um canal DMA alimentando o FIFO de transmissão do i2c do painel; on_done é chamada (em interrupção)
+// ao fim de cada envio. Painéis em blocos i2c diferentes enviam ao mesmo tempo, cada um no seu canal
+void ssd1306_dma_init(ssd1306_t *ssd, void (*on_done)(ssd1306_t *ssd)) {
+    static bool irq_added = false;
+    i2c_hw_t *hw = i2c_get_hw(ssd->bus->i2c);
+
+    ssd->dma_done = on_done;
+    ssd->dma_channel = dma_claim_unused_channel(true);
+
+    dma_channel_config config = dma_channel_get_default_config(ssd->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, i2c_get_dreq(ssd->bus->i2c, true));
+    dma_channel_configure(ssd->dma_channel, &config, &hw->data_cmd, ssd->dma_words, 0, false);
+
+    dma_channel_set_irq0_enabled(ssd->dma_channel, true);
+    if (!irq_added) {
+        irq_add_shared_handler(DMA_IRQ_0, dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        irq_added = true;
+    }
+}
+
+// Sequência de palavras para o registrador IC_DATA_CMD: cada página alterada vira uma transação de
+// comandos e uma de dados, e o bit STOP na última palavra de cada uma encerra a transação.
+// Copia os trechos alterados para a sequência do DMA e dispara o envio, retornando imediatamente.
+// Retorna false se não houver nada a enviar; não deve ser chamada com um envio ainda em andamento, e
+// cada envio disparado termina com ssd1306_flush_end
+bool ssd1306_flush_async(ssd1306_t *ssd) {
+    uint16_t *words = ssd->dma_words;
+    int count = 0;
+    int transactions = 0;
+    int start, end;
+
+    for (int page = 0; page < ssd->pages; page++) {
+        if (!take_dirty_span(ssd, page, &start, &end)) {
+            continue;
+        }
+
+        words[count++] = 0x00;
+        words[count++] = ssd1306_set_column_address;
+        words[count++] = start;
+        words[count++] = end - 1;
+        words[count++] = ssd1306_set_page_address;
+        words[count++] = page;
+        words[count++] = page | I2C_IC_DATA_CMD_STOP_BITS;
+
+        words[count++] = 0x40;
+        const uint8_t *row = ssd->buffer + page * ssd->width;
+        for (int x = start; x < end; x++) {
+            words[count++] = row[x];
+        }
+        words[count - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+        transactions += 2;
+    }
+
+    ssd->shadow_valid = true;
+    ssd->dma_words_count = count;
+
+    if (count == 0) {
+        return false;
+    }
+
+    // O endereço do escravo vem do registrador TAR, que uma recuperação do barramento apaga. Ele só pode
+    // mudar com o bloco desligado, e desligá-lo no meio de uma transmissão corta o que ainda está no FIFO:
+    // só é reprogramado quando outro endereço foi usado, e depois de o bloco terminar
+    i2c_hw_t *hw = i2c_get_hw(ssd->bus->i2c);
+    if ((hw->tar & I2C_IC_TAR_IC_TAR_BITS) != ssd->address) {
+        i2c_bus_wait_idle(ssd->bus, i2c_bus_timeout_us(ssd->bus, I2C_BUS_FIFO_DEPTH));
+        hw->enable = 0;
+        hw->tar = ssd->address;
+        hw->enable = 1;
+    }
+
+    i2c_bus_count(ssd->bus, transactions, count);
+    dma_channel_transfer_from_buffer_now(ssd->dma_channel, words, count);
+    return true;
+}
 
-    const int bytes_per_row = ssd1306_width;
+// O envio disparado por ssd1306_flush_async terminou de sair pelo barramento: depois do fim do DMA, o
+// FIFO do i2c esvaziou e o STOP saiu. Não espera
+bool ssd1306_flush_done(ssd1306_t *ssd) {
+    return i2c_bus_idle(ssd->bus);
+}
+
+// Tempo máximo do envio disparado por ssd1306_flush_async, no clock atual do barramento
+uint32_t ssd1306_flush_timeout_us(const ssd1306_t *ssd) {
+    return i2c_bus_timeout_us(ssd->bus, ssd->dma_words_count);
+}
+
+// Encerra o envio por DMA: completed diz se o DMA terminou ou se o tempo de ssd1306_flush_timeout_us
+// acabou antes. O fim do DMA só quer dizer que a última palavra entrou no FIFO: o quadro chegou quando o
+// bloco fica ocioso (o FIFO esvaziou e o STOP saiu), e só então um NACK dos últimos bytes aparece. Um NACK
+// faz o bloco descartar o resto da sequência e deixa o abort registrado. Em qualquer falha o DMA é parado,
+// o barramento é recuperado num clock mais baixo e a próxima chamada de ssd1306_flush_async reenvia a
+// tela inteira. Retorna se o quadro chegou ao painel
+bool ssd1306_flush_end(ssd1306_t *ssd, bool completed) {
+    if (completed && !i2c_bus_wait_idle(ssd->bus, i2c_bus_timeout_us(ssd->bus, I2C_BUS_FIFO_DEPTH))) {
+        completed = false;
+    }
+    if (completed && !(i2c_get_hw(ssd->bus->i2c)->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) {
+        return true;
+    }
 
-    int byte_idx = (y / 8) * bytes_per_row + x;
-    uint8_t byte = ssd[byte_idx];
+    if (!completed) {
+        // Como recomenda o SDK: sem a interrupção habilitada, o abort não dispara um fim de envio falso
+        dma_channel_set_irq0_enabled(ssd->dma_channel, false);
+        dma_channel_abort(ssd->dma_channel);
+        dma_channel_acknowledge_irq0(ssd->dma_channel);
+        dma_channel_set_irq0_enabled(ssd->dma_channel, true);
+    }
+
+    i2c_bus_fail(ssd->bus, !completed);
+    ssd->shadow_valid = false;
+    return false;
+}
+
+// Escreve um pixel no framebuffer, sem marcar a região como alterada
+static inline void put_pixel(ssd1306_t *ssd, int x, int y, bool set) {
+    int byte_idx = (y / 8) * ssd->width + x;
+    uint8_t byte = ssd->buffer[byte_idx];
 
     if (set) {
         byte |= 1 << (y % 8);
@@ -101,11 +440,143 @@ void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
         byte &= ~(1 << (y % 8));
     }
 
-    ssd[byte_idx] = byte;
+    ssd->buffer[byte_idx] = byte;
+}
+
+// Determina o pixel a ser aceso (no display) de acordo com a coordenada fornecida
+void ssd1306_set_pixel(ssd1306_t *ssd, int x, int y, bool set) {
+    assert(x >= 0 && x < ssd->width && y >= 0 && y < ssd->height);
+
+    put_pixel(ssd, x, y, set);
+    mark_dirty_region(ssd, x, y, x, y);
+}
+
+// Aplica a mesma máscara de linhas a count bytes seguidos de uma página: bytes inteiros acesos ou apagados
+// viram um memset; o resto é feito de 4 em 4 bytes, com a máscara repetida numa palavra de 32 bits
+static void raster_run(uint8_t *dst, int count, uint8_t mask, ssd1306_color_t color) {
+    if (mask == 0xFF && color != SSD1306_COLOR_INVERT) {
+        memset(dst, color == SSD1306_COLOR_WHITE ? 0xFF : 0x00, count);
+        return;
+    }
+
+    uint32_t mask_word = mask * 0x01010101u;
+    uint32_t word;
+
+    for (; count > 0 && ((uintptr_t)dst & 3); count--, dst++) {
+        if (color == SSD1306_COLOR_WHITE) *dst |= mask;
+        else if (color == SSD1306_COLOR_BLACK) *dst &= ~mask;
+        else *dst ^= mask;
+    }
+    for (; count >= 4; count -= 4, dst += 4) {
+        memcpy(&word, dst, 4);
+        if (color == SSD1306_COLOR_WHITE) word |= mask_word;
+        else if (color == SSD1306_COLOR_BLACK) word &= ~mask_word;
+        else word ^= mask_word;
+        memcpy(dst, &word, 4);
+    }
+    for (; count > 0; count--, dst++) {
+        if (color == SSD1306_COLOR_WHITE) *dst |= mask;
+        else if (color == SSD1306_COLOR_BLACK) *dst &= ~mask;
+        else *dst ^= mask;
+    }
+}
+
+// Preenche o retângulo (recortado ao display) acendendo, apagando ou invertendo os pixels: em cada página
+// uma única máscara cobre as linhas do retângulo, e as colunas são percorridas byte a byte (ou palavra a
+// palavra), sem tocar pixel por pixel
+void ssd1306_fill_rect(ssd1306_t *ssd, int x, int y, int width, int height, ssd1306_color_t color) {
+    int x_0 = x < 0 ? 0 : x;
+    int y_0 = y < 0 ? 0 : y;
+    int x_1 = x + width > ssd->width ? ssd->width - 1 : x + width - 1;
+    int y_1 = y + height > ssd->height ? ssd->height - 1 : y + height - 1;
+
+    if (x_0 > x_1 || y_0 > y_1) {
+        return;
+    }
+
+    for (int page = y_0 / 8; page <= y_1 / 8; page++) {
+        int top = page == y_0 / 8 ? y_0 % 8 : 0;
+        int bottom = page == y_1 / 8 ? y_1 % 8 : 7;
+        uint8_t mask = (0xFF << top) & (0xFF >> (7 - bottom));
+
+        raster_run(ssd->buffer + page * ssd->width + x_0, x_1 - x_0 + 1, mask, color);
+    }
+    mark_dirty_region(ssd, x_0, y_0, x_1, y_1);
+}
+
+// Linha horizontal de width pixels a partir de (x, y)
+void ssd1306_hline(ssd1306_t *ssd, int x, int y, int width, ssd1306_color_t color) {
+    ssd1306_fill_rect(ssd, x, y, width, 1, color);
+}
+
+// Linha vertical de height pixels a partir de (x, y): um byte por página
+void ssd1306_vline(ssd1306_t *ssd, int x, int y, int height, ssd1306_color_t color) {
+    ssd1306_fill_rect(ssd, x, y, 1, height, color);
+}
+
+// Contorno do retângulo; os lados verticais não repetem os cantos, para que SSD1306_COLOR_INVERT inverta
+// cada pixel uma única vez
+void ssd1306_draw_rect(ssd1306_t *ssd, int x, int y, int width, int height, ssd1306_color_t color) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    ssd1306_hline(ssd, x, y, width, color);
+    if (height > 1) {
+        ssd1306_hline(ssd, x, y + height - 1, width, color);
+    }
+    if (height > 2) {
+        ssd1306_vline(ssd, x, y + 1, height - 2, color);
+        if (width > 1) {
+            ssd1306_vline(ssd, x + width - 1, y + 1, height - 2, color);
+        }
+    }
+}
+
+// Desenha uma imagem de width x height pixels (bytes de coluna página por página, como os glifos) com o canto
+// superior esquerdo em (x, y), em qualquer linha: cada byte é deslocado entre duas páginas do display. Só os
+// bits acesos em mask (mesmo formato; NULL: a imagem inteira) são escritos, o resto do fundo fica. O que
+// passar das bordas é recortado
+void ssd1306_blit_masked(ssd1306_t *ssd, const uint8_t *image, const uint8_t *mask, int width, int height, int x, int y) {
+    int pages = (height + 7) / 8;
+    int first = x < 0 ? -x : 0;
+    int last = x + width > ssd->width ? ssd->width - x : width;
+    int page_0 = y >= 0 ? y / 8 : -((7 - y) / 8); // Divisão arredondada para baixo
+    int shift = y - page_0 * 8;
+
+    if (first >= last || height <= 0 || y >= ssd->height || y + height <= 0) {
+        return;
+    }
+
+    for (int p = 0; p < pages; p++) {
+        const uint8_t *src = image + p * width;
+        const uint8_t *src_mask = mask ? mask + p * width : NULL;
+        uint8_t rows = p == pages - 1 && height % 8 ? 0xFF >> (8 - height % 8) : 0xFF; // Linhas da imagem nesta página
+        int page = page_0 + p;
+
+        if (page >= 0 && page < ssd->pages) {
+            uint8_t *dst = ssd->buffer + page * ssd->width + x;
+            for (int i = first; i < last; i++) {
+                uint8_t m = ((src_mask ? src_mask[i] : 0xFF) & rows) << shift;
+                dst[i] = (dst[i] & ~m) | ((src[i] << shift) & m);
+            }
+        }
+        if (shift && page + 1 >= 0 && page + 1 < ssd->pages) {
+            uint8_t *dst = ssd->buffer + (page + 1) * ssd->width + x;
+            for (int i = first; i < last; i++) {
+                uint8_t m = ((src_mask ? src_mask[i] : 0xFF) & rows) >> (8 - shift);
+                dst[i] = (dst[i] & ~m) | ((src[i] >> (8 - shift)) & m);
+            }
+        }
+    }
+
+    int y_0 = y < 0 ? 0 : y;
+    int y_1 = y + height > ssd->height ? ssd->height - 1 : y + height - 1;
+    mark_dirty_region(ssd, x + first, y_0, x + last - 1, y_1);
 }
 
-// Algoritmo de Bresenham básico
-void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set) {
+// Algoritmo de Bresenham básico; linhas horizontais e verticais vão direto para ssd1306_fill_rect
+void ssd1306_draw_line(ssd1306_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set) {
     int dx = abs(x_1 - x_0); // Deslocamentos
     int dy = -abs(y_1 - y_0);
     int sx = x_0 < x_1 ? 1 : -1; // Direção de avanço
@@ -113,8 +584,18 @@ void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool se
     int error = dx + dy; // Erro acumulado
     int error_2;
 
+    assert(x_0 >= 0 && x_0 < ssd->width && y_0 >= 0 && y_0 < ssd->height);
+    assert(x_1 >= 0 && x_1 < ssd->width && y_1 >= 0 && y_1 < ssd->height);
+    if (x_0 == x_1 || y_0 == y_1) {
+        ssd1306_fill_rect(ssd, MIN(x_0, x_1), MIN(y_0, y_1), abs(x_1 - x_0) + 1, abs(y_1 - y_0) + 1,
+                          set ? SSD1306_COLOR_WHITE : SSD1306_COLOR_BLACK);
+        return;
+    }
+
+    mark_dirty_region(ssd, MIN(x_0, x_1), MIN(y_0, y_1), MAX(x_0, x_1), MAX(y_0, y_1)); // Marca a caixa da linha uma única vez
+
     while (true) {
-        ssd1306_set_pixel(ssd, x_0, y_0, set); // Acende pixel no ponto atual
+        put_pixel(ssd, x_0, y_0, set); // Acende pixel no ponto atual
         if (x_0 == x_1 && y_0 == y_1) {
             break; // Verifica se o ponto final foi alcançado
         }
@@ -132,114 +613,243 @@ void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool se
     }
 }
 
-// Adquire os pixels para um caractere (de acordo com ssd1306_font.h)
-inline int ssd1306_get_font(uint8_t character)
-{
-  if (character >= 'A' && character <= 'Z') {
-    return character - 'A' + 1;
-  }
-  else if (character >= '0' && character <= '9') {
-    return character - '0' + 27;
-  }
-  else
-    return 0;
+// Copia as colunas [first, last) de um glifo para o framebuffer, com o canto superior esquerdo em (x, y).
+// A célula é opaca (os bits apagados do glifo apagam o fundo). Com y múltiplo de 8 cada página do glifo é
+// copiada direto; senão cada coluna é deslocada entre duas páginas. Bytes fora do ASCII (>= 0x80, como os
+// de uma sequência UTF-8) saem em branco. Não marca as páginas alteradas
+static inline void blit_glyph(ssd1306_t *ssd, const ssd1306_font_t *font, int x, int y, char character, int first, int last) {
+    uint8_t code = (uint8_t)character;
+    const uint8_t *column = font->glyphs + (code < 128 ? font->index[code] : 0) * font->width * font->pages + first;
+    const int stride = ssd->width;
+    uint8_t *dst = ssd->buffer + (y / 8) * stride + x + first;
+    int count = last - first;
+    int shift = y % 8;
+
+    if (shift == 0) {
+        for (int page = 0; page < font->pages; page++, column += font->width, dst += stride) {
+            // Glifos inteiros das fontes 8x8 e 16x16 viram cópias de tamanho fixo
+            if (count == 8) {
+                memcpy(dst, column, 8);
+            }
+            else if (count == 16) {
+                memcpy(dst, column, 16);
+            }
+            else {
+                memcpy(dst, column, count);
+            }
+        }
+        return;
+    }
+
+    uint8_t low_mask = 0xFF << shift;
+    uint8_t high_mask = 0xFF >> (8 - shift);
+    for (int page = 0; page < font->pages; page++, column += font->width, dst += stride) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = (dst[i] & ~low_mask) | (column[i] << shift);
+            dst[i + stride] = (dst[i + stride] & ~high_mask) | (column[i] >> (8 - shift));
+        }
+    }
 }
 
-// Desenha um único caractere no display
-void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character) {
-    if (x > ssd1306_width - 8 || y > ssd1306_height - 8) {
+// Desenha um glifo da fonte em (x, y); colunas fora da tela são recortadas, mas o glifo precisa caber
+// inteiro na vertical
+void ssd1306_draw_glyph(ssd1306_t *ssd, const ssd1306_font_t *font, int x, int y, char character) {
+    int first = x < 0 ? -x : 0;
+    int last = x + font->width > ssd->width ? ssd->width - x : font->width;
+
+    if (y < 0 || y > ssd->height - font->pages * 8 || first >= last) {
         return;
     }
 
-    y = y / 8;
+    blit_glyph(ssd, font, x, y, character, first, last);
+    mark_dirty_region(ssd, x + first, y, x + last - 1, y + font->pages * 8 - 1);
+}
+
+// Desenha um texto com a fonte dada e devolve a largura ocupada em pixels; o que passar da borda é recortado.
+// A região alterada é marcada uma vez para o texto todo
+int ssd1306_draw_text(ssd1306_t *ssd, const ssd1306_font_t *font, int x, int y, const char *string) {
+    int start = x;
 
-    character = toupper(character);
-    int idx = ssd1306_get_font(character);
-    int fb_idx = y * 128 + x;
+    if (y < 0 || y > ssd->height - font->pages * 8) {
+        return 0;
+    }
+
+    for (; *string && x + font->width <= 0; string++) {
+        x += font->width;
+    }
+    if (*string && x < 0) {
+        blit_glyph(ssd, font, x, y, *string++, -x, font->width);
+        x += font->width;
+    }
+    for (; *string && x + font->width <= ssd->width; string++) {
+        blit_glyph(ssd, font, x, y, *string, 0, font->width);
+        x += font->width;
+    }
+    if (*string && x < ssd->width) {
+        blit_glyph(ssd, font, x, y, *string, 0, ssd->width - x);
+        x = ssd->width;
+    }
 
-    for (int i = 0; i < 8; i++) {
-        ssd[fb_idx++] = font[idx * 8 + i];
+    int x_0 = start < 0 ? 0 : start;
+    if (x > x_0) {
+        mark_dirty_region(ssd, x_0, y, x - 1, y + font->pages * 8 - 1);
     }
+    return x - start;
 }
 
-// Desenha uma string, chamando a função de desenhar caractere várias vezes
-void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string) {
-    if (x > ssd1306_width - 8 || y > ssd1306_height - 8) {
-        return;
+// Desenha um único caractere no display
+void ssd1306_draw_char(ssd1306_t *ssd, int16_t x, int16_t y, uint8_t character) {
+    ssd1306_draw_glyph(ssd, &ssd1306_font_8x8, x, y, character);
+}
+
+// Desenha uma string com a fonte 8x8
+void ssd1306_draw_string(ssd1306_t *ssd, int16_t x, int16_t y, const char *string) {
+    ssd1306_draw_text(ssd, &ssd1306_font_8x8, x, y, string);
+}
+
+// Destino de uma imagem no framebuffer: começa em (x, page) e só o que cai no recorte [x_0, x_1] x
+// [page_0, page_1] é escrito
+typedef struct {
+    ssd1306_t *ssd;
+    int x, page;
+    int x_0, x_1, page_0, page_1;
+} image_target_t;
+
+// Escreve count bytes da imagem a partir da posição index (página por página), copiados de src ou, com src
+// NULL, repetindo fill; cada trecho de uma página é recortado uma vez e copiado em bloco
+static void blit_span(const image_target_t *target, int width, int index, const uint8_t *src, uint8_t fill, int count) {
+    while (count > 0) {
+        int column = index % width;
+        int page = target->page + index / width;
+        int length = width - column < count ? width - column : count;
+        int x_0 = target->x + column;
+        int x_1 = x_0 + length - 1;
+        int skip = x_0 < target->x_0 ? target->x_0 - x_0 : 0;
+
+        if (x_1 > target->x_1) x_1 = target->x_1;
+
+        if (page >= target->page_0 && page <= target->page_1 && x_0 + skip <= x_1) {
+            uint8_t *dst = target->ssd->buffer + page * target->ssd->width + x_0 + skip;
+            int n = x_1 - (x_0 + skip) + 1;
+
+            if (src) memcpy(dst, src + skip, n);
+            else memset(dst, fill, n);
+        }
+
+        index += length;
+        count -= length;
+        if (src) src += length;
     }
+}
 
-    while (*string) {
-        ssd1306_draw_char(ssd, x, y, *string++);
-        x += 8;
+// Decodifica a imagem direto no destino, sem buffer intermediário
+static void blit_image(const image_target_t *target, const ssd1306_image_t *image) {
+    const uint8_t *data = image->data;
+    const uint8_t *end = image->data + image->size;
+    int total = image->width * image->pages;
+    int index = 0;
+
+    switch (image->format) {
+    case SSD1306_IMAGE_RAW:
+        blit_span(target, image->width, 0, data, 0, total < image->size ? total : image->size);
+        break;
+
+    case SSD1306_IMAGE_RLE:
+        while (data < end && index < total) {
+            uint8_t n = *data++;
+            if (n < 0x80) {
+                int count = n + 1;
+                if (count > end - data) count = end - data;
+                if (count > total - index) count = total - index;
+                blit_span(target, image->width, index, data, 0, count);
+                data += n + 1;
+                index += count;
+            }
+            else if (data < end) {
+                int count = n - 0x7D;
+                if (count > total - index) count = total - index;
+                blit_span(target, image->width, index, NULL, *data++, count);
+                index += count;
+            }
+        }
+        break;
+
+    case SSD1306_IMAGE_PAGE_DELTA:
+        while (end - data >= 3) {
+            int page = data[0];
+            int column = data[1];
+            int count = data[2];
+            data += 3;
+            if (count > end - data || page >= image->pages || column + count > image->width) {
+                break; // Trecho corrompido
+            }
+            blit_span(target, image->width, page * image->width + column, data, 0, count);
+            data += count;
+        }
+        break;
     }
 }
 
-// Comando de configuração com base na estrutura ssd1306_t
-void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
-  ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-	ssd->i2c_port, ssd->address, ssd->port_buffer, 2, false );
+// Monta o destino da imagem em (x, page), recortado a clip (NULL: o display inteiro) e à própria imagem;
+// retorna falso se nada fica visível
+static bool image_target(image_target_t *target, ssd1306_t *ssd, const ssd1306_image_t *image, int x, int page,
+                         const struct render_area *clip) {
+    target->ssd = ssd;
+    target->x = x;
+    target->page = page;
+    target->x_0 = clip ? clip->start_column : 0;
+    target->x_1 = clip ? clip->end_column : ssd->width - 1;
+    target->page_0 = clip ? clip->start_page : 0;
+    target->page_1 = clip ? clip->end_page : ssd->pages - 1;
+
+    if (target->x_0 < x) target->x_0 = x;
+    if (target->page_0 < page) target->page_0 = page;
+    if (target->x_1 > x + image->width - 1) target->x_1 = x + image->width - 1;
+    if (target->page_1 > page + image->pages - 1) target->page_1 = page + image->pages - 1;
+    if (target->x_0 < 0) target->x_0 = 0;
+    if (target->page_0 < 0) target->page_0 = 0;
+    if (target->x_1 > ssd->width - 1) target->x_1 = ssd->width - 1;
+    if (target->page_1 > ssd->pages - 1) target->page_1 = ssd->pages - 1;
+
+    return target->x_0 <= target->x_1 && target->page_0 <= target->page_1;
 }
 
-// Função de configuração do display para o caso do bitmap
-void ssd1306_config(ssd1306_t *ssd) {
-    ssd1306_command(ssd, ssd1306_set_display | 0x00);
-    ssd1306_command(ssd, ssd1306_set_memory_mode);
-    ssd1306_command(ssd, 0x01);
-    ssd1306_command(ssd, ssd1306_set_display_start_line | 0x00);
-    ssd1306_command(ssd, ssd1306_set_segment_remap | 0x01);
-    ssd1306_command(ssd, ssd1306_set_mux_ratio);
-    ssd1306_command(ssd, ssd1306_height - 1);
-    ssd1306_command(ssd, ssd1306_set_common_output_direction | 0x08);
-    ssd1306_command(ssd, ssd1306_set_display_offset);
-    ssd1306_command(ssd, 0x00);
-    ssd1306_command(ssd, ssd1306_set_common_pin_configuration);
-    ssd1306_command(ssd, 0x12);
-    ssd1306_command(ssd, ssd1306_set_display_clock_divide_ratio);
-    ssd1306_command(ssd, 0x80);
-    ssd1306_command(ssd, ssd1306_set_precharge);
-    ssd1306_command(ssd, 0xF1);
-    ssd1306_command(ssd, ssd1306_set_vcomh_deselect_level);
-    ssd1306_command(ssd, 0x30);
-    ssd1306_command(ssd, ssd1306_set_contrast);
-    ssd1306_command(ssd, 0xFF);
-    ssd1306_command(ssd, ssd1306_set_entire_on);
-    ssd1306_command(ssd, ssd1306_set_normal_display);
-    ssd1306_command(ssd, ssd1306_set_charge_pump);
-    ssd1306_command(ssd, 0x14);
-    ssd1306_command(ssd, ssd1306_set_display | 0x01);
-}
-
-// Inicializa o display para o caso de exibição de bitmap
-void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
-    ssd->width = width;
-    ssd->height = height;
-    ssd->pages = height / 8U;
-    ssd->address = address;
-    ssd->i2c_port = i2c;
-    ssd->bufsize = ssd->pages * ssd->width + 1;
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
-    ssd->ram_buffer[0] = 0x40;
-    ssd->port_buffer[0] = 0x80;
+// Desenha a imagem no framebuffer com o canto superior esquerdo na coluna x e página page, recortada a clip
+// (NULL: o display inteiro), e marca a região alterada. Uma imagem SSD1306_IMAGE_PAGE_DELTA só reescreve os
+// seus trechos: a base precisa já estar no lugar
+void ssd1306_blit_image(ssd1306_t *ssd, const ssd1306_image_t *image, int x, int page, const struct render_area *clip) {
+    image_target_t target;
+
+    if (!image_target(&target, ssd, image, x, page, clip)) {
+        return;
+    }
+
+    blit_image(&target, image);
+    mark_dirty_region(ssd, target.x_0, target.page_0 * 8, target.x_1, target.page_1 * 8 + 7);
 }
 
-// Envia os dados ao display
-void ssd1306_send_data(ssd1306_t *ssd) {
-    ssd1306_command(ssd, ssd1306_set_column_address);
-    ssd1306_command(ssd, 0);
-    ssd1306_command(ssd, ssd->width - 1);
-    ssd1306_command(ssd, ssd1306_set_page_address);
-    ssd1306_command(ssd, 0);
-    ssd1306_command(ssd, ssd->pages - 1);
-    i2c_write_blocking(
-    ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false );
+// Desenha a imagem como ssd1306_blit_image e envia só o que mudou
+void ssd1306_draw_image(ssd1306_t *ssd, const ssd1306_image_t *image, int x, int page, const struct render_area *clip) {
+    ssd1306_blit_image(ssd, image, x, page, clip);
+    ssd1306_flush(ssd);
 }
 
-// Desenha o bitmap (a ser fornecido em display_oled.c) no display
+// Desenha o bitmap (a ser fornecido em display_oled.c) no display, numa cópia e num único envio. O bitmap
+// ocupa a tela inteira no formato do endereçamento vertical (coluna por coluna, uma página por byte) e é
+// transposto para o framebuffer
 void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap) {
-    for (int i = 0; i < ssd->bufsize - 1; i++) {
-        ssd->ram_buffer[i + 1] = bitmap[i];
+    struct render_area frame = {
+        .start_column = 0,
+        .end_column = ssd->width - 1,
+        .start_page = 0,
+        .end_page = ssd->pages - 1,
+    };
 
-        ssd1306_send_data(ssd);
+    for (int x = 0; x < ssd->width; x++) {
+        for (int page = 0; page < ssd->pages; page++) {
+            ssd->buffer[page * ssd->width + x] = *bitmap++;
+        }
     }
+
+    render_on_display(ssd, &frame);
 }
@@ -0,0 +1,238 @@
+#include <assert.h>
+#include <stdio.h>
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE deve ser potência de 2");
+
+// Ring de um único produtor por vez: só ele escreve os registros e avança head (as rings compartilhadas
+// escrevem numa seção crítica, veja trace_push_shared). O leitor não consome nada,
+// apenas copia os TRACE_RING_SIZE mais recentes e descarta os que foram sobrescritos durante a cópia
+typedef struct
+{
+    const char *name;
+    volatile uint32_t head;
+    trace_record_t records[TRACE_RING_SIZE];
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_MAX_RINGS];
+static int ring_count = 0;
+static trace_ring_t *isr_rings[NUM_CORES];
+static trace_ring_t overflow_ring = {.name = "overflow"}; // Produtores além de TRACE_MAX_RINGS (pode misturar eventos)
+static TaskHandle_t trace_task_handle = NULL;
+
+static const struct
+{
+    const char *name;
+    char phase; // Fase do Chrome trace: 'B'/'E' na mesma task, 'b'/'e' entre contextos, 'i' instantâneo
+} trace_info[TRACE_ID_COUNT] = {
+    [TRACE_KEY_EDGE] = {"key_edge", 'i'},
+    [TRACE_KEY_EVENT] = {"key_event", 'i'},
+    [TRACE_KEY_HANDLED] = {"key_handled", 'i'},
+    [TRACE_FEEDBACK] = {"feedback", 'i'},
+    [TRACE_VERIFY_BEGIN] = {"verify", 'B'},
+    [TRACE_VERIFY_END] = {"verify", 'E'},
+    [TRACE_FLASH_BEGIN] = {"flash_write", 'B'},
+    [TRACE_FLASH_END] = {"flash_write", 'E'},
+    [TRACE_FRAME_COMMIT] = {"frame_commit", 'i'},
+    [TRACE_FLUSH_BEGIN] = {"flush", 'b'},
+    [TRACE_FLUSH_END] = {"flush", 'e'},
+};
+
+static trace_ring_t *trace_claim_ring(const char *name)
+{
+    trace_ring_t *ring = &overflow_ring;
+
+    // Seção crítica do kernel: no SMP ela também exclui o outro núcleo
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    if (ring_count < TRACE_MAX_RINGS)
+    {
+        ring = &rings[ring_count++];
+        ring->name = name;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(status);
+
+    return ring;
+}
+
+static inline void trace_push(trace_ring_t *ring, trace_id_t id, uint16_t arg)
+{
+    uint32_t head = ring->head;
+    trace_record_t *record = &ring->records[head & (TRACE_RING_SIZE - 1)];
+
+    record->time_us = time_us_32();
+    record->id = id;
+    record->arg = arg;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Rings com mais de um produtor possível: a de interrupções de cada núcleo (uma interrupção aninhada, como a
+// do DMA sobre a do GPIO, interromperia um registro pela metade) e a de excedentes. A seção crítica do kernel
+// desliga as interrupções do núcleo e, no SMP, também exclui o outro
+static void trace_push_shared(trace_ring_t *ring, trace_id_t id, uint16_t arg)
+{
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    trace_push(ring, id, arg);
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+void trace_event_from_isr(trace_id_t id, uint16_t arg)
+{
+    uint core = get_core_num();
+
+    if (isr_rings[core] == NULL)
+        isr_rings[core] = trace_claim_ring(core ? "isr core1" : "isr core0");
+
+    trace_push_shared(isr_rings[core], id, arg);
+}
+
+// Cada task recebe sua ring no primeiro evento, guardada no armazenamento local da própria task
+void trace_event(trace_id_t id, uint16_t arg)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+    {
+        trace_event_from_isr(id, arg);
+        return;
+    }
+
+    trace_ring_t *ring = pvTaskGetThreadLocalStoragePointer(NULL, TRACE_TLS_INDEX);
+    if (ring == NULL)
+    {
+        ring = trace_claim_ring(pcTaskGetName(NULL));
+        vTaskSetThreadLocalStoragePointer(NULL, TRACE_TLS_INDEX, ring);
+    }
+
+    if (ring == &overflow_ring)
+        trace_push_shared(ring, id, arg);
+    else
+        trace_push(ring, id, arg);
+}
+
+// Copia os registros ainda válidos da ring; retorna a quantidade e o índice do primeiro
+static int trace_snapshot(const trace_ring_t *ring, trace_record_t *out)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+
+    for (uint32_t i = first; i < head; i++)
+        out[i - first] = ring->records[i & (TRACE_RING_SIZE - 1)];
+
+    // O produtor pode ter avançado durante a cópia: os registros que ele alcançou não valem mais
+    uint32_t now = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t valid_from = now > TRACE_RING_SIZE ? now - TRACE_RING_SIZE : 0;
+    int skip = valid_from > first ? valid_from - first : 0;
+    int count = head - first;
+
+    if (skip >= count)
+        return 0;
+
+    for (int i = skip; i < count; i++)
+        out[i - skip] = out[i];
+    return count - skip;
+}
+
+static trace_record_t snapshot[TRACE_RING_SIZE];
+
+static int trace_ring_total()
+{
+    return ring_count + (overflow_ring.head != 0);
+}
+
+static trace_ring_t *trace_ring_at(int index)
+{
+    return index < ring_count ? &rings[index] : &overflow_ring;
+}
+
+// JSON no formato do Chrome trace (chrome://tracing, Perfetto): cada ring vira uma "thread"
+void trace_dump_chrome()
+{
+    bool first = true;
+
+    printf("{\"traceEvents\":[\n");
+    for (int r = 0; r < trace_ring_total(); r++)
+    {
+        trace_ring_t *ring = trace_ring_at(r);
+
+        printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+               first ? "" : ",\n", r, ring->name);
+        first = false;
+
+        int count = trace_snapshot(ring, snapshot);
+        for (int i = 0; i < count; i++)
+        {
+            trace_record_t *record = &snapshot[i];
+            if (record->id >= TRACE_ID_COUNT)
+                continue;
+
+            char phase = trace_info[record->id].phase;
+            printf(",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%d,\"args\":{\"arg\":%u}%s}",
+                   trace_info[record->id].name, phase, (unsigned long)record->time_us, r, record->arg,
+                   phase == 'b' || phase == 'e' ? ",\"cat\":\"async\",\"id\":1" : phase == 'i' ? ",\"s\":\"t\"" : "");
+        }
+    }
+    printf("\n]}\n");
+}
+
+// Formato binário: "VTRC", versão e quantidade de rings (uint16); para cada ring, índice e quantidade de
+// registros (uint16) seguidos dos seus registros trace_record_t. A quantidade sai da mesma cópia que os
+// registros, então bate mesmo com os produtores escrevendo durante o dump. Vai direto para o stdio, sem a
+// conversão de \n em \r\n
+void trace_dump_binary()
+{
+    struct
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t rings;
+    } header = {{'V', 'T', 'R', 'C'}, 2, trace_ring_total()};
+
+    stdio_put_string((const char *)&header, sizeof(header), false, false);
+    for (int r = 0; r < header.rings; r++)
+    {
+        struct
+        {
+            uint16_t ring;
+            uint16_t count;
+        } ring_header = {r, trace_snapshot(trace_ring_at(r), snapshot)};
+
+        for (int i = 0; i < ring_header.count; i++)
+            snapshot[i].ring = r;
+        stdio_put_string((const char *)&ring_header, sizeof(ring_header), false, false);
+        stdio_put_string((const char *)snapshot, ring_header.count * sizeof(trace_record_t), false, false);
+    }
+}
+
+static void trace_chars_available(void *param)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(trace_task_handle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Atende os pedidos de dump pelo stdio: 't' imprime o Chrome trace, 'b' o formato binário
+static void task_trace(void *params)
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int c;
+        while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+        {
+            if (c == 't')
+                trace_dump_chrome();
+            else if (c == 'b')
+                trace_dump_binary();
+        }
+    }
+}
+
+void trace_init()
+{
+    xTaskCreate(task_trace, "Trace Task", TRACE_TASK_STACK, NULL, TRACE_TASK_PRIORITY, &trace_task_handle);
+    stdio_set_chars_available_callback(trace_chars_available, NULL);
+}
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "ui.h"
+#include "display.h"
+
+static ssd1306_t *canvas = NULL; // Painel da Display Task, em cujo framebuffer os widgets desenham
+static ui_screen_t *current = NULL;
+static bool changed = false; // Algum widget foi desenhado desde ui_begin
+
+void ui_init(ssd1306_t *ssd)
+{
+    canvas = ssd;
+}
+
+// Os widgets são alterados com a tela do display travada (o estado retido fica protegido pelo mesmo mutex);
+// o quadro só é submetido à Display Task se algo mudou
+void ui_begin()
+{
+    display_begin();
+    changed = false;
+}
+
+void ui_end()
+{
+    if (changed)
+        display_commit();
+    else
+        display_release();
+}
+
+// Troca a tela exibida; pedir a tela atual não apaga nada
+void ui_show(ui_screen_t *screen)
+{
+    if (screen == current)
+        return;
+
+    ssd1306_clear(canvas);
+    display_set_cursor(0, 0, 0, 0);
+    for (int i = 0; i < screen->count; i++)
+        screen->widgets[i].valid = false;
+    current = screen;
+    changed = true;
+}
+
+// Desenha o texto, cortado ou completado com espaços até o tamanho do widget, só nas células que diferem
+// do que está na tela. Se a fonte ou a linha mudam, o texto anterior é apagado antes
+static void draw_cells(ui_widget_t *widget, const ssd1306_font_t *font, int y, const char *text)
+{
+    char padded[UI_TEXT_MAX + 1];
+    int cells = widget->cells > UI_TEXT_MAX ? UI_TEXT_MAX : widget->cells;
+
+    snprintf(padded, sizeof(padded), "%-*.*s", cells, cells, text);
+
+    if (widget->valid && (widget->font != font || widget->font_y != y))
+    {
+        char blank[UI_TEXT_MAX + 1];
+        memset(blank, ' ', cells);
+        blank[cells] = '\0';
+        ssd1306_draw_text(canvas, widget->font, widget->x, widget->font_y, blank);
+        widget->valid = false;
+        changed = true;
+    }
+
+    // Widget apagado (por ui_show ou acima): a tela já tem espaços em todas as células
+    if (!widget->valid)
+    {
+        memset(widget->text, ' ', cells);
+        widget->font = font;
+        widget->font_y = y;
+        widget->valid = true;
+    }
+
+    for (int i = 0; i < cells; i++)
+    {
+        if (widget->text[i] == padded[i])
+            continue;
+
+        ssd1306_draw_glyph(canvas, font, widget->x + i * font->width, y, padded[i]);
+        widget->text[i] = padded[i];
+        changed = true;
+    }
+}
+
+void ui_text(ui_widget_t *widget, const char *text)
+{
+    draw_cells(widget, &ssd1306_font_8x8, widget->y, text);
+}
+
+void ui_textf(ui_widget_t *widget, const char *format, ...)
+{
+    char buffer[UI_TEXT_MAX + 1];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    ui_text(widget, buffer);
+}
+
+// Campo de senha de 16 linhas: enquanto a senha cabe numa linha, os dígitos usam a fonte 16x16; depois
+// seguem em 8x8, centrados na vertical. Oculta, cada dígito vira um 'x'. Um cursor piscante sublinha a
+// célula do próximo dígito
+void ui_pin(ui_widget_t *widget, const char *pswd, bool visible)
+{
+    char buffer[UI_TEXT_MAX + 1];
+    int cells = widget->cells > UI_TEXT_MAX ? UI_TEXT_MAX : widget->cells;
+    int len = strnlen(pswd, cells);
+    const ssd1306_font_t *font = &ssd1306_font_16x16;
+    int y = widget->y;
+
+    for (int i = 0; i < len; i++)
+        buffer[i] = visible ? pswd[i] : 'x';
+    buffer[len] = '\0';
+
+    if (len * ssd1306_font_16x16.width > canvas->width - widget->x)
+    {
+        font = &ssd1306_font_8x8;
+        y += 4;
+    }
+
+    // O cursor sai da posição antiga antes de os dígitos serem desenhados por cima dela
+    int cursor_x = widget->x + len * font->width;
+    int cursor_width = font->width - font->pages;
+    if (len < cells && cursor_x + cursor_width <= canvas->width)
+        changed |= display_set_cursor(cursor_x, y + font->pages * 7, cursor_width, font->pages);
+    else
+        changed |= display_set_cursor(0, 0, 0, 0);
+
+    draw_cells(widget, font, y, buffer);
+}
+
+// Imagem do tamanho do widget (widget->cells colunas por widget->pages páginas); NULL apaga a área. Um delta
+// desenhado sobre a sua base reescreve só os trechos que mudam
+void ui_icon(ui_widget_t *widget, const ssd1306_image_t *image)
+{
+    struct render_area area = {
+        .start_column = widget->x,
+        .end_column = widget->x + widget->cells - 1,
+        .start_page = widget->y / 8,
+        .end_page = widget->y / 8 + widget->pages - 1,
+    };
+
+    if (widget->valid && widget->icon == image)
+        return;
+
+    if (!image)
+        ssd1306_fill_rect(canvas, widget->x, widget->y, widget->cells, widget->pages * 8, SSD1306_COLOR_BLACK);
+    else
+    {
+        if (image->base && !(widget->valid && widget->icon == image->base))
+            ssd1306_blit_image(canvas, image->base, widget->x, area.start_page, &area);
+        ssd1306_blit_image(canvas, image, widget->x, area.start_page, &area);
+    }
+
+    widget->icon = image;
+    widget->valid = true;
+    changed = true;
+}
+
+// Barra de progresso em qualquer linha: contorno de 1 pixel e o interior (a 2 pixels da borda) preenchido na
+// proporção value / max. Depois do primeiro desenho só a faixa entre o preenchimento antigo e o novo muda
+void ui_bar(ui_widget_t *widget, int value, int max)
+{
+    int inner = widget->cells - 4;
+    int filled = max > 0 ? inner * MIN(MAX(value, 0), max) / max : 0;
+
+    if (!widget->valid)
+    {
+        ssd1306_fill_rect(canvas, widget->x, widget->y, widget->cells, widget->pages, SSD1306_COLOR_BLACK);
+        ssd1306_draw_rect(canvas, widget->x, widget->y, widget->cells, widget->pages, SSD1306_COLOR_WHITE);
+        widget->filled = 0;
+        widget->valid = true;
+        changed = true;
+    }
+
+    if (filled == widget->filled)
+        return;
+
+    int from = MIN(filled, widget->filled);
+    int to = MAX(filled, widget->filled);
+    ssd1306_fill_rect(canvas, widget->x + 2 + from, widget->y + 2, to - from, widget->pages - 4,
+                      filled > widget->filled ? SSD1306_COLOR_WHITE : SSD1306_COLOR_BLACK);
+    widget->filled = filled;
+    changed = true;
+}
@@ -0,0 +1,666 @@
+// Gerador de assets do display, executado no host durante o build: converte as fontes (BDF) e as imagens
+// (PBM) listadas num manifesto em vetores constantes no formato de páginas do SSD1306 (bytes de coluna com o
+// bit 0 na linha de cima, página por página), prontos para ssd1306_draw_text e ssd1306_blit_image.
+//
+//   assetgen -o <diretório de saída> <manifesto>
+//
+// Gera assets.c, assets.h e o relatório assets_size.txt (também impresso no stdout). Cada linha do manifesto
+// descreve um asset; os caminhos são relativos ao manifesto e # inicia um comentário:
+//
+//   font  <símbolo> <arquivo.bdf> [upper] [scale=N]
+//   image <símbolo> <arquivo.pbm> [raw | rle | auto | delta=<símbolo da imagem base>]
+//
+// Fontes: só os glifos distintos são gravados (o glifo 0 é o branco), com uma tabela de 128 posições que leva
+// cada código ASCII ao seu glifo; upper faz as minúsculas sem desenho usarem as maiúsculas e scale amplia os
+// pixels. Imagens: raw grava as páginas como estão, rle comprime em blocos, auto (o padrão) fica com o menor
+// dos dois e delta grava só os trechos que diferem da imagem base
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ASSETS 64
+#define MAX_NAME 64
+#define MAX_PATH 512
+#define MAX_WIDTH 128 // Maior imagem ou glifo: o display inteiro
+#define MAX_HEIGHT 64
+#define FONT_CODES 128
+
+typedef enum
+{
+    FORMAT_RAW, // Valores de ssd1306_image_format_t
+    FORMAT_RLE,
+    FORMAT_PAGE_DELTA,
+    FORMAT_AUTO,
+} format_t;
+
+static const char *const format_names[] = {"SSD1306_IMAGE_RAW", "SSD1306_IMAGE_RLE", "SSD1306_IMAGE_PAGE_DELTA"};
+
+typedef struct
+{
+    bool font;
+    char name[MAX_NAME];
+    char path[MAX_PATH];
+    int line;
+
+    int width;
+    int pages;
+
+    // Fonte
+    bool upper;
+    int scale;
+    uint8_t index[FONT_CODES];
+    int glyph_count;
+    uint8_t *glyphs; // glyph_count * width * pages
+
+    // Imagem
+    format_t format;
+    char base[MAX_NAME];
+    uint8_t *image; // width * pages, sem compressão
+    uint8_t *packed;
+    int packed_size;
+} asset_t;
+
+static asset_t assets[MAX_ASSETS];
+static int asset_count = 0;
+
+static void die(const char *format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "assetgen: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static void *checked_calloc(size_t count, size_t size)
+{
+    void *p = calloc(count ? count : 1, size);
+
+    if (!p)
+        die("out of memory");
+    return p;
+}
+
+// Converte pixels (um byte por pixel, linha por linha) para páginas de 8 linhas
+static void pixels_to_pages(const uint8_t *pixels, int width, int height, uint8_t *pages)
+{
+    memset(pages, 0, width * ((height + 7) / 8));
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            if (pixels[y * width + x])
+                pages[(y / 8) * width + x] |= 1 << (y % 8);
+}
+
+// Lê o próximo número de um PBM, saltando espaços e comentários
+static int pbm_number(FILE *file, const char *path)
+{
+    int c;
+    int value = 0;
+
+    while ((c = fgetc(file)) != EOF)
+    {
+        if (c == '#')
+            while ((c = fgetc(file)) != EOF && c != '\n')
+                ;
+        else if (!isspace(c))
+            break;
+    }
+    if (!isdigit(c))
+        die("%s: malformed PBM header", path);
+    while (isdigit(c))
+    {
+        value = value * 10 + c - '0';
+        c = fgetc(file);
+    }
+    return value;
+}
+
+// PBM texto (P1) ou binário (P4); 1 é um pixel aceso
+static uint8_t *read_pbm(const char *path, int *width, int *height)
+{
+    FILE *file = fopen(path, "rb");
+    char magic[2];
+
+    if (!file)
+        die("%s: %s", path, strerror(errno));
+    if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '1' && magic[1] != '4'))
+        die("%s: not a P1/P4 PBM", path);
+
+    *width = pbm_number(file, path);
+    *height = pbm_number(file, path);
+    if (*width <= 0 || *width > MAX_WIDTH || *height <= 0 || *height > MAX_HEIGHT)
+        die("%s: %dx%d is outside 1x1..%dx%d", path, *width, *height, MAX_WIDTH, MAX_HEIGHT);
+
+    uint8_t *pixels = checked_calloc(*width * *height, 1);
+    for (int y = 0; y < *height; y++)
+    {
+        for (int x = 0; x < *width; x++)
+        {
+            int c;
+            if (magic[1] == '1')
+            {
+                while ((c = fgetc(file)) != EOF && (isspace(c) || c == '#'))
+                    if (c == '#')
+                        while ((c = fgetc(file)) != EOF && c != '\n')
+                            ;
+                if (c != '0' && c != '1')
+                    die("%s: truncated pixel data", path);
+                pixels[y * *width + x] = c == '1';
+            }
+            else
+            {
+                static int bits;
+                if (x % 8 == 0 && (bits = fgetc(file)) == EOF)
+                    die("%s: truncated pixel data", path);
+                pixels[y * *width + x] = (bits >> (7 - x % 8)) & 1;
+            }
+        }
+    }
+
+    fclose(file);
+    return pixels;
+}
+
+// Glifos BDF desenhados na célula da fonte (FONTBOUNDINGBOX, com a linha de base em FONT_ASCENT) e ampliados
+// scale vezes; os códigos fora de 0..127 são ignorados
+static void read_bdf(asset_t *asset)
+{
+    FILE *file = fopen(asset->path, "r");
+    char line[256];
+    int cell_width = 0, cell_height = 0, cell_x = 0, cell_y = 0;
+    int ascent = -1;
+    int code = -1;
+    int bbx_width = 0, bbx_height = 0, bbx_x = 0, bbx_y = 0;
+    int row = -1;
+    uint8_t cell[MAX_HEIGHT * MAX_WIDTH];
+    uint8_t *cells[FONT_CODES] = {0};
+
+    if (!file)
+        die("%s: %s", asset->path, strerror(errno));
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (row >= 0)
+        {
+            if (strncmp(line, "ENDCHAR", 7) == 0)
+            {
+                if (code >= 0 && code < FONT_CODES)
+                {
+                    cells[code] = checked_calloc(cell_width * cell_height, 1);
+                    memcpy(cells[code], cell, cell_width * cell_height);
+                }
+                row = -1;
+                continue;
+            }
+
+            // Linha do bitmap: bits da esquerda para a direita, do mais significativo ao menos
+            int top = ascent - (bbx_y - cell_y) - bbx_height;
+            int y = top + row++;
+            for (int x = 0; x < bbx_width; x++)
+            {
+                char digit[2] = {line[x / 4], 0};
+                int nibble = (int)strtol(digit, NULL, 16);
+                int cx = bbx_x - cell_x + x;
+                if ((nibble >> (3 - x % 4)) & 1)
+                {
+                    if (cx < 0 || cx >= cell_width || y < 0 || y >= cell_height)
+                        die("%s: glyph %d falls outside the font bounding box", asset->path, code);
+                    cell[y * cell_width + cx] = 1;
+                }
+            }
+            continue;
+        }
+
+        if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &cell_width, &cell_height, &cell_x, &cell_y) == 4)
+        {
+            if (cell_width <= 0 || cell_width * asset->scale > MAX_WIDTH || cell_height <= 0 ||
+                cell_height * asset->scale > MAX_HEIGHT)
+                die("%s: font cell %dx%d (scale %d) is too large", asset->path, cell_width, cell_height, asset->scale);
+        }
+        else if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1)
+            ;
+        else if (sscanf(line, "ENCODING %d", &code) == 1)
+            ;
+        else if (sscanf(line, "BBX %d %d %d %d", &bbx_width, &bbx_height, &bbx_x, &bbx_y) == 4)
+            ;
+        else if (strncmp(line, "BITMAP", 6) == 0)
+        {
+            if (cell_width == 0)
+                die("%s: BITMAP before FONTBOUNDINGBOX", asset->path);
+            if (ascent < 0)
+                ascent = cell_height + cell_y;
+            memset(cell, 0, sizeof(cell));
+            row = 0;
+        }
+    }
+    fclose(file);
+
+    if (cell_width == 0)
+        die("%s: no FONTBOUNDINGBOX", asset->path);
+
+    if (asset->upper)
+        for (int c = 'a'; c <= 'z'; c++)
+            if (!cells[c] && cells[toupper(c)])
+            {
+                cells[c] = checked_calloc(cell_width * cell_height, 1);
+                memcpy(cells[c], cells[toupper(c)], cell_width * cell_height);
+            }
+
+    // Ampliação e conversão para páginas; glifos repetidos (e os brancos) compartilham uma posição
+    int width = cell_width * asset->scale;
+    int height = cell_height * asset->scale;
+    int glyph_size = width * ((height + 7) / 8);
+    uint8_t scaled[MAX_HEIGHT * MAX_WIDTH];
+    uint8_t pages[MAX_WIDTH * MAX_HEIGHT / 8];
+
+    asset->width = width;
+    asset->pages = (height + 7) / 8;
+    asset->glyphs = checked_calloc(FONT_CODES + 1, glyph_size);
+    asset->glyph_count = 1;
+
+    for (int c = 0; c < FONT_CODES; c++)
+    {
+        asset->index[c] = 0;
+        if (!cells[c])
+            continue;
+
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                scaled[y * width + x] = cells[c][(y / asset->scale) * cell_width + x / asset->scale];
+        pixels_to_pages(scaled, width, height, pages);
+
+        int slot = 0;
+        while (slot < asset->glyph_count && memcmp(asset->glyphs + slot * glyph_size, pages, glyph_size) != 0)
+            slot++;
+        if (slot == asset->glyph_count)
+            memcpy(asset->glyphs + asset->glyph_count++ * glyph_size, pages, glyph_size);
+        if (slot > 255)
+            die("%s: more than 255 distinct glyphs", asset->path);
+
+        asset->index[c] = slot;
+        free(cells[c]);
+    }
+}
+
+// RLE de ssd1306_image_t: n < 0x80 seguido de n + 1 bytes literais; n >= 0x80 seguido de um byte repetido
+// n - 0x7D vezes (3 a 130). Repetições de 3 ou mais bytes viram um bloco de repetição
+static int rle_encode(const uint8_t *data, int size, uint8_t *out)
+{
+    int length = 0;
+    int i = 0;
+
+    while (i < size)
+    {
+        int run = 1;
+        while (i + run < size && data[i + run] == data[i] && run < 130)
+            run++;
+
+        if (run >= 3)
+        {
+            out[length++] = run + 0x7D;
+            out[length++] = data[i];
+            i += run;
+            continue;
+        }
+
+        // Literais até a próxima repetição de 3 bytes
+        int start = i;
+        while (i < size && i - start < 128 && !(i + 2 < size && data[i] == data[i + 1] && data[i] == data[i + 2]))
+            i++;
+        out[length++] = i - start - 1;
+        memcpy(out + length, data + start, i - start);
+        length += i - start;
+    }
+
+    return length;
+}
+
+// Trechos {página, coluna, n, n bytes} que diferem da base; trechos separados por até 3 bytes iguais são
+// unidos, pois um cabeçalho novo custa 3 bytes
+static int delta_encode(const uint8_t *data, const uint8_t *base, int width, int pages, uint8_t *out)
+{
+    int length = 0;
+
+    for (int page = 0; page < pages; page++)
+    {
+        const uint8_t *row = data + page * width;
+        const uint8_t *base_row = base + page * width;
+        int x = 0;
+
+        while (x < width)
+        {
+            if (row[x] == base_row[x])
+            {
+                x++;
+                continue;
+            }
+
+            int start = x;
+            int end = x + 1;
+            for (int next = end; next < width && next - start < 255; next++)
+            {
+                if (row[next] != base_row[next])
+                {
+                    if (next - end > 3)
+                        break;
+                    end = next + 1;
+                }
+            }
+
+            out[length++] = page;
+            out[length++] = start;
+            out[length++] = end - start;
+            memcpy(out + length, row + start, end - start);
+            length += end - start;
+            x = end;
+        }
+    }
+
+    return length;
+}
+
+static asset_t *find_asset(const char *name)
+{
+    for (int i = 0; i < asset_count; i++)
+        if (strcmp(assets[i].name, name) == 0)
+            return &assets[i];
+    return NULL;
+}
+
+static void read_image(asset_t *asset)
+{
+    int height;
+    uint8_t *pixels = read_pbm(asset->path, &asset->width, &height);
+
+    asset->pages = (height + 7) / 8;
+    asset->image = checked_calloc(asset->width * asset->pages, 1);
+    pixels_to_pages(pixels, asset->width, height, asset->image);
+    free(pixels);
+}
+
+// As imagens delta são comprimidas depois de todas lidas, pois a base pode vir depois no manifesto
+static void pack_image(asset_t *asset, const char *manifest)
+{
+    int size = asset->width * asset->pages;
+    // Pior caso do RLE: um byte de cabeçalho a cada 128; do delta: um trecho de 3 + 1 bytes por coluna
+    asset->packed = checked_calloc(size * 4 + 16, 1);
+
+    if (asset->format == FORMAT_PAGE_DELTA)
+    {
+        asset_t *base = find_asset(asset->base);
+        if (!base || base->font)
+            die("%s:%d: delta base %s is not an image", manifest, asset->line, asset->base);
+        if (base->width != asset->width || base->pages != asset->pages)
+            die("%s:%d: %s and its base %s differ in size", manifest, asset->line, asset->name, base->name);
+        asset->packed_size = delta_encode(asset->image, base->image, asset->width, asset->pages, asset->packed);
+        return;
+    }
+
+    int rle_size = rle_encode(asset->image, size, asset->packed);
+    if (asset->format == FORMAT_RLE || (asset->format == FORMAT_AUTO && rle_size < size))
+    {
+        asset->format = FORMAT_RLE;
+        asset->packed_size = rle_size;
+        return;
+    }
+
+    asset->format = FORMAT_RAW;
+    memcpy(asset->packed, asset->image, size);
+    asset->packed_size = size;
+}
+
+static void read_manifest(const char *manifest)
+{
+    FILE *file = fopen(manifest, "r");
+    char line[1024];
+    char dir[MAX_PATH] = "";
+    int number = 0;
+
+    if (!file)
+        die("%s: %s", manifest, strerror(errno));
+
+    const char *slash = strrchr(manifest, '/');
+    if (slash)
+        snprintf(dir, sizeof(dir), "%.*s/", (int)(slash - manifest), manifest);
+
+    while (fgets(line, sizeof(line), file))
+    {
+        char *fields[8];
+        int count = 0;
+
+        number++;
+        char *comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+        for (char *token = strtok(line, " \t\r\n"); token && count < 8; token = strtok(NULL, " \t\r\n"))
+            fields[count++] = token;
+        if (count == 0)
+            continue;
+        if (count < 3)
+            die("%s:%d: expected <font|image> <symbol> <file> [options]", manifest, number);
+        if (asset_count == MAX_ASSETS)
+            die("%s:%d: more than %d assets", manifest, number, MAX_ASSETS);
+        if (find_asset(fields[1]))
+            die("%s:%d: duplicate symbol %s", manifest, number, fields[1]);
+
+        asset_t *asset = &assets[asset_count++];
+        asset->line = number;
+        asset->scale = 1;
+        asset->format = FORMAT_AUTO;
+        snprintf(asset->name, sizeof(asset->name), "%s", fields[1]);
+        snprintf(asset->path, sizeof(asset->path), "%s%s", fields[2][0] == '/' ? "" : dir, fields[2]);
+
+        if (strcmp(fields[0], "font") == 0)
+            asset->font = true;
+        else if (strcmp(fields[0], "image") != 0)
+            die("%s:%d: unknown asset kind %s", manifest, number, fields[0]);
+
+        for (int i = 3; i < count; i++)
+        {
+            if (asset->font && strcmp(fields[i], "upper") == 0)
+                asset->upper = true;
+            else if (asset->font && sscanf(fields[i], "scale=%d", &asset->scale) == 1 && asset->scale >= 1)
+                ;
+            else if (!asset->font && strcmp(fields[i], "raw") == 0)
+                asset->format = FORMAT_RAW;
+            else if (!asset->font && strcmp(fields[i], "rle") == 0)
+                asset->format = FORMAT_RLE;
+            else if (!asset->font && strcmp(fields[i], "auto") == 0)
+                asset->format = FORMAT_AUTO;
+            else if (!asset->font && strncmp(fields[i], "delta=", 6) == 0)
+            {
+                asset->format = FORMAT_PAGE_DELTA;
+                snprintf(asset->base, sizeof(asset->base), "%s", fields[i] + 6);
+            }
+            else
+                die("%s:%d: unknown option %s", manifest, number, fields[i]);
+        }
+
+        if (asset->font)
+            read_bdf(asset);
+        else
+            read_image(asset);
+    }
+    fclose(file);
+
+    for (int i = 0; i < asset_count; i++)
+        if (!assets[i].font)
+            pack_image(&assets[i], manifest);
+}
+
+static FILE *open_output(const char *dir, const char *name)
+{
+    char path[MAX_PATH];
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if (!(file = fopen(path, "w")))
+        die("%s: %s", path, strerror(errno));
+    return file;
+}
+
+static void write_bytes(FILE *out, const uint8_t *data, int size)
+{
+    for (int i = 0; i < size; i++)
+        fprintf(out, "%s0x%02X,%s", i % 12 == 0 ? "    " : "", data[i], i % 12 == 11 || i == size - 1 ? "\n" : " ");
+}
+
+// Nome do símbolo em maiúsculas, para as constantes de índice
+static const char *upper_name(const char *name)
+{
+    static char buffer[MAX_NAME];
+    int i = 0;
+
+    for (; name[i] && i < MAX_NAME - 1; i++)
+        buffer[i] = toupper((unsigned char)name[i]);
+    buffer[i] = '\0';
+    return buffer;
+}
+
+static void write_header(const char *dir)
+{
+    FILE *out = open_output(dir, "assets.h");
+
+    fprintf(out, "// Gerado por tools/assetgen a partir de assets/assets.txt: não edite\n");
+    fprintf(out, "#ifndef ASSETS_H\n#define ASSETS_H\n\n#include \"ssd1306.h\"\n\n");
+
+    for (int i = 0; i < asset_count; i++)
+        if (assets[i].font)
+            fprintf(out, "extern const ssd1306_font_t %s;\n", assets[i].name);
+    fprintf(out, "\n");
+
+    // As imagens também são acessadas pela posição numa tabela, sem busca
+    fprintf(out, "typedef enum\n{\n");
+    for (int i = 0; i < asset_count; i++)
+        if (!assets[i].font)
+            fprintf(out, "    ASSET_%s,\n", upper_name(assets[i].name));
+    fprintf(out, "    ASSET_IMAGE_COUNT,\n} asset_image_t;\n\n");
+
+    for (int i = 0; i < asset_count; i++)
+        if (!assets[i].font)
+            fprintf(out, "extern const ssd1306_image_t %s;\n", assets[i].name);
+    fprintf(out, "extern const ssd1306_image_t *const asset_images[ASSET_IMAGE_COUNT];\n\n#endif\n");
+    fclose(out);
+}
+
+static void write_source(const char *dir)
+{
+    FILE *out = open_output(dir, "assets.c");
+
+    fprintf(out, "// Gerado por tools/assetgen a partir de assets/assets.txt: não edite\n");
+    fprintf(out, "#include \"assets.h\"\n\n");
+    fprintf(out, "// Os dados ficam na flash (seção .flashdata), mesmo num binário copiado para a RAM\n");
+    fprintf(out, "#ifndef __in_flash\n#define __in_flash(group)\n#endif\n\n");
+
+    for (int i = 0; i < asset_count; i++)
+    {
+        const asset_t *asset = &assets[i];
+
+        if (asset->font)
+        {
+            int glyph_size = asset->width * asset->pages;
+            fprintf(out, "// %s: %dx%d, %d glifos distintos\n", asset->name, asset->width, asset->pages * 8,
+                    asset->glyph_count);
+            fprintf(out, "static const uint8_t __in_flash(\"assets\") %s_glyphs[] = {\n", asset->name);
+            write_bytes(out, asset->glyphs, asset->glyph_count * glyph_size);
+            fprintf(out, "};\n\nstatic const uint8_t __in_flash(\"assets\") %s_index[128] = {\n", asset->name);
+            write_bytes(out, asset->index, FONT_CODES);
+            fprintf(out, "};\n\nconst ssd1306_font_t %s = {\n", asset->name);
+            fprintf(out, "    .width = %d, .pages = %d, .glyphs = %s_glyphs, .index = %s_index};\n\n", asset->width,
+                    asset->pages, asset->name, asset->name);
+            continue;
+        }
+
+        fprintf(out, "// %s: %dx%d, %d bytes em vez de %d\n", asset->name, asset->width, asset->pages * 8,
+                asset->packed_size, asset->width * asset->pages);
+        fprintf(out, "static const uint8_t __in_flash(\"assets\") %s_data[] = {\n", asset->name);
+        write_bytes(out, asset->packed, asset->packed_size);
+        fprintf(out, "};\n\nconst ssd1306_image_t %s = {\n", asset->name);
+        fprintf(out, "    .width = %d, .pages = %d, .format = %s, .size = sizeof(%s_data), .data = %s_data", asset->width,
+                asset->pages, format_names[asset->format], asset->name, asset->name);
+        if (asset->format == FORMAT_PAGE_DELTA)
+            fprintf(out, ",\n    .base = &%s", asset->base);
+        fprintf(out, "};\n\n");
+    }
+
+    fprintf(out, "const ssd1306_image_t *const asset_images[ASSET_IMAGE_COUNT] = {\n");
+    for (int i = 0; i < asset_count; i++)
+        if (!assets[i].font)
+            fprintf(out, "    [ASSET_%s] = &%s,\n", upper_name(assets[i].name), assets[i].name);
+    fprintf(out, "};\n");
+    fclose(out);
+}
+
+// Relatório de tamanho: bytes na flash de cada asset contra a forma sem empacotamento (a fonte com os 128
+// glifos diretos, a imagem com todas as páginas)
+static void write_report(FILE *out)
+{
+    int total_plain = 0;
+    int total_flash = 0;
+
+    fprintf(out, "%-24s %-6s %-10s %7s %7s %6s\n", "asset", "kind", "format", "plain", "flash", "ratio");
+    for (int i = 0; i < asset_count; i++)
+    {
+        const asset_t *asset = &assets[i];
+        char format[16];
+        int plain, flash;
+
+        if (asset->font)
+        {
+            plain = FONT_CODES * asset->width * asset->pages;
+            flash = asset->glyph_count * asset->width * asset->pages + FONT_CODES;
+            snprintf(format, sizeof(format), "%d glyphs", asset->glyph_count);
+        }
+        else
+        {
+            plain = asset->width * asset->pages;
+            flash = asset->packed_size;
+            snprintf(format, sizeof(format), "%s", asset->format == FORMAT_RAW ? "raw" : asset->format == FORMAT_RLE ? "rle" : "delta");
+        }
+
+        fprintf(out, "%-24s %-6s %-10s %7d %7d %5.0f%%\n", asset->name, asset->font ? "font" : "image", format, plain,
+                flash, 100.0 * flash / plain);
+        total_plain += plain;
+        total_flash += flash;
+    }
+    fprintf(out, "%-24s %-6s %-10s %7d %7d %5.0f%%\n", "total", "", "", total_plain, total_flash,
+            total_plain ? 100.0 * total_flash / total_plain : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = NULL;
+    const char *manifest = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            dir = argv[++i];
+        else
+            manifest = argv[i];
+    }
+    if (!dir || !manifest)
+    {
+        fprintf(stderr, "usage: assetgen -o <output dir> <manifest>\n");
+        return 2;
+    }
+
+    read_manifest(manifest);
+    write_header(dir);
+    write_source(dir);
+
+    FILE *report = open_output(dir, "assets_size.txt");
+    write_report(report);
+    fclose(report);
+    write_report(stdout);
+    return 0;
+}
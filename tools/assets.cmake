@@ -0,0 +1,46 @@
+# Fontes e imagens do display geradas no build: tools/assetgen converte o que assets/assets.txt lista em
+# ${ASSETS_OUTPUT_DIR}/assets.c e assets.h (vetores constantes na flash) e imprime o relatório de tamanho, que
+# também fica em assets_size.txt. Uso: include(tools/assets.cmake) e target_add_assets(<target>)
+
+get_filename_component(ASSETS_DIR ${CMAKE_CURRENT_LIST_DIR}/../assets ABSOLUTE)
+set(ASSETS_MANIFEST ${ASSETS_DIR}/assets.txt)
+set(ASSETS_OUTPUT_DIR ${CMAKE_BINARY_DIR}/generated/assets)
+
+# Num build cruzado (o firmware) o gerador é um projeto à parte com o compilador do host, como o pioasm do SDK
+if (CMAKE_CROSSCOMPILING)
+    include(ExternalProject)
+    set(ASSETGEN_BINARY_DIR ${CMAKE_BINARY_DIR}/assetgen)
+    ExternalProject_Add(assetgen_build
+        SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR}/assetgen
+        BINARY_DIR ${ASSETGEN_BINARY_DIR}
+        CMAKE_ARGS -DCMAKE_BUILD_TYPE=Release
+        BUILD_ALWAYS 1
+        INSTALL_COMMAND ""
+        BUILD_BYPRODUCTS ${ASSETGEN_BINARY_DIR}/assetgen${CMAKE_HOST_EXECUTABLE_SUFFIX}
+    )
+    set(ASSETGEN_EXECUTABLE ${ASSETGEN_BINARY_DIR}/assetgen${CMAKE_HOST_EXECUTABLE_SUFFIX})
+    set(ASSETGEN_DEPENDS assetgen_build)
+else()
+    add_executable(assetgen ${CMAKE_CURRENT_LIST_DIR}/assetgen/assetgen.c)
+    set(ASSETGEN_EXECUTABLE $<TARGET_FILE:assetgen>)
+    set(ASSETGEN_DEPENDS assetgen)
+endif()
+
+file(GLOB ASSETS_SOURCES ${ASSETS_DIR}/fonts/* ${ASSETS_DIR}/icons/*)
+
+add_custom_command(
+    OUTPUT ${ASSETS_OUTPUT_DIR}/assets.c ${ASSETS_OUTPUT_DIR}/assets.h ${ASSETS_OUTPUT_DIR}/assets_size.txt
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${ASSETS_OUTPUT_DIR}
+    COMMAND ${ASSETGEN_EXECUTABLE} -o ${ASSETS_OUTPUT_DIR} ${ASSETS_MANIFEST}
+    DEPENDS ${ASSETGEN_DEPENDS} ${ASSETS_MANIFEST} ${ASSETS_SOURCES}
+    COMMENT "Generating display assets from ${ASSETS_MANIFEST}"
+    VERBATIM
+)
+
+add_custom_target(assets DEPENDS ${ASSETS_OUTPUT_DIR}/assets.c ${ASSETS_OUTPUT_DIR}/assets.h)
+
+function(target_add_assets target)
+    target_sources(${target} PRIVATE ${ASSETS_OUTPUT_DIR}/assets.c)
+    target_include_directories(${target} PRIVATE ${ASSETS_OUTPUT_DIR})
+    add_dependencies(${target} assets)
+endfunction()